@@ -1,7 +1,12 @@
-#define _POSIX_C_SOURCE 199309L
+#define _POSIX_C_SOURCE 200809L
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
 #include <unistd.h>
 #include <time.h>
+#include <signal.h>
+#include <sys/types.h>
 #include <wayland-server.h>
 #include <wayland-util.h>
 
@@ -13,6 +18,7 @@
 #include <wlr/render/interface.h>
 #include <wlr/types/wlr_keyboard.h>
 #include <wlr/types/wlr_cursor.h>
+#include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_xcursor_manager.h>
 #include <wlr/types/wlr_xdg_decoration_v1.h>
 #include <wlr/types/wlr_server_decoration.h>
@@ -53,27 +59,112 @@ struct be_screen_t {
     struct wl_listener frame_listener;
 
     struct wl_list windows; // be_window.link
+
+    // identifies the monitor across restarts and reconnects
+    char id[128];
 };
 
+/* Counts events per second, in whole seconds of the monotonic clock: the
+   count for the last full second is kept while the next one is counted. */
+typedef struct {
+    time_t sec;
+    uint32_t this_sec;
+    uint32_t last_sec;
+} rate_t;
+
+/* What one wl_client is costing us.  It is found from the client with
+   wl_client_get_destroy_listener(), and it lives until both the client and
+   all of its surfaces are gone, because the client is destroyed first. */
+typedef struct {
+    struct wl_client *wl_client;
+    struct wl_listener destroyed;
+    bool gone;
+    struct wl_list link; // backend_t.clients
+    // a window to name the client by, if it has one
+    be_window_t *named;
+    uint32_t surfaces;
+    size_t buffer_bytes;
+    rate_t commits;
+    rate_t frames;
+    // from sending a size until the commit after it was acked
+    uint64_t configures;
+    uint64_t configure_total_us;
+    uint32_t configure_max_us;
+} client_t;
+
 struct be_window_t {
     backend_t *be;
     void *venowm_data;
+    client_t *client;
     // base wl_surface, the first thing to be created
     struct wlr_surface *wlr_surface;
     struct wl_listener wlr_surface_destroyed;
+    struct wl_listener wlr_surface_commit;
+
+    /* About how much memory the surface's texture takes, counted in
+       backend_t.texture_bytes.  Hidden windows wait in backend_t.lru, the
+       one hidden the longest first, to be evicted if the total gets over
+       budget.  An evicted window is asked to shrink to EVICT_SIZE, so that
+       its next buffer (and texture) is tiny, and it gets its real size back
+       when it is shown. */
+    size_t texture_bytes;
+    struct wl_list lru_link; // backend_t.lru
+    bool in_lru;
+    bool evicted;
+    // windows which are still drawing aren't worth evicting
+    uint64_t last_commit_us;
 
     // xdg_surface, extends a wl_surface
     struct wlr_xdg_surface *xdg_surface;
     bool mapped; // the application says if it's mapped or not
+    // from handle_window_plan(), kept until the window maps
+    void *plan;
+    bool planned;
     struct wl_listener xdg_destroyed;
     struct wl_listener xdg_mapped;
     struct wl_listener xdg_unmapped;
+    // the toplevel's title and app_id, once it is mapped
+    struct wl_listener set_title;
+    struct wl_listener set_app_id;
+    bool props_listening;
+    /* Our copies of the title and app_id, which is what venowm sees.  They
+       are brought up to date at most once per PROPS_DELAY_MS, so a terminal
+       which sets its title for every command it runs costs one update. */
+    char *title;
+    char *app_id;
+    bool props_dirty;
+    struct wl_list props_link; // backend_t.props_dirty
+
+    /* Set when the client stops answering pings, cleared when it answers
+       again.  A hung client is not sent any sizes meanwhile. */
+    bool unresponsive;
+    /* Set when we ping the client, cleared when the ping times out.  wlroots
+       clears its ping serial both on a pong and on a timeout, so this is how
+       the two are told apart. */
+    bool ping_outstanding;
+    struct wl_listener ping_timeout;
+    // after asking the window to close, in case it never does
+    struct wl_event_source *close_timer;
+    bool sent_sigterm;
 
     // display properties
     int32_t x;
     int32_t y;
     bool show; // we decide if the application is shown or not
     struct wl_list link; // be_screen_t.windows
+
+    /* Sizes are sent to the application at most once per output frame, and
+       only after it has acked the last one, so resizing doesn't pile up
+       configures faster than the application can redraw.  The newest size
+       waits here until then.  Afterwards pending_w and pending_h remember the
+       last size we asked for, so asking again costs nothing. */
+    uint32_t pending_w;
+    uint32_t pending_h;
+    bool sized;
+    bool size_pending;
+    bool configured_this_frame;
+    // when the last size was sent, until the client has drawn it
+    uint64_t configure_sent_us;
 };
 
 /*
@@ -107,6 +198,8 @@ typedef struct {
     // func should return "true" to consume the keypress
     bool (*func)(backend_t*, void*);
     void *data;
+    // call func again while the key is held down
+    bool repeat;
 } keybinding_t;
 
 // custom hashtable mapping (X keysym + modifier)s to function/data pairs
@@ -159,8 +252,75 @@ struct backend_t {
 
     // for interacting with frontend
     be_window_t *focus;
+
+    // memory pool for be_window_t's
+    slab_t window_slab;
+
+    // windows whose title or app_id changed since the last update
+    struct wl_list props_dirty; // be_window_t.props_link
+    struct wl_event_source *props_timer;
+    bool props_armed;
+
+    // every client is pinged this often, see be_set_hung_policy()
+    struct wl_event_source *ping_timer;
+    bool kill_hung;
+
+    // texture memory, see be_set_texture_budget()
+    size_t texture_bytes;
+    size_t texture_budget;
+    struct wl_list lru; // be_window_t.lru_link
+    struct wl_event_source *evict_timer;
+    bool evict_armed;
+
+    struct wl_list clients; // client_t.link
 };
 
+// about one frame at 60Hz
+#define PROPS_DELAY_MS 16
+
+#define PING_INTERVAL_MS 5000
+// between SIGTERM and SIGKILL
+#define KILL_DELAY_MS 2000
+
+// a hidden window has to be this quiet before it is evicted
+#define EVICT_IDLE_MS 1000
+// clients are free to make it bigger, to their smallest size
+#define EVICT_SIZE 1
+
+static slab_type_t be_window_slab_type = SLAB_TYPE(be_window_t);
+
+static void be_window_send_size(be_window_t *be_window);
+static void plan_window(be_window_t *be_window);
+
+static uint64_t now_us(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static void rate_roll(rate_t *rate, time_t sec){
+    if(sec == rate->sec) return;
+    // a second with nothing in it counts as zero
+    rate->last_sec = sec == rate->sec + 1 ? rate->this_sec : 0;
+    rate->this_sec = 0;
+    rate->sec = sec;
+}
+
+static void rate_tick(rate_t *rate, uint64_t us){
+    rate_roll(rate, (time_t)(us / 1000000));
+    rate->this_sec++;
+}
+
+static void send_frame_done(be_window_t *be_window, struct timespec *now){
+    struct wlr_surface *srfc = be_window->wlr_surface;
+    // only count the frames the client asked for
+    bool asked = !wl_list_empty(&srfc->current.frame_callback_list);
+    wlr_surface_send_frame_done(srfc, now);
+    if(asked && be_window->client){
+        rate_tick(&be_window->client->frames, now_us());
+    }
+}
+
 ///// Backend Screen Functions
 
 static void be_screen_free(be_screen_t *be_screen){
@@ -203,6 +363,15 @@ static void handle_frame(struct wl_listener *l, void *data){
     }
     wlr_renderer_begin(r, o->width, o->height);
 
+    // windows are positioned in layout coordinates, find our offset
+    int32_t ox = 0, oy = 0;
+    struct wlr_box *obox = wlr_output_layout_get_box(
+            be_screen->be->output_layout, o);
+    if(obox){
+        ox = obox->x;
+        oy = obox->y;
+    }
+
     // render a blue background
     float color[4] = {0.0, 0.0, 0.5, 1.0};
     wlr_renderer_clear(r, color);
@@ -211,6 +380,10 @@ static void handle_frame(struct wl_listener *l, void *data){
     // render all the windows on this screen
     be_window_t *be_window;
     wl_list_for_each(be_window, &be_screen->windows, link){
+        // a new frame, so each window may get another size
+        be_window->configured_this_frame = false;
+        if(be_window->size_pending) be_window_send_size(be_window);
+
         // don't render windows not mapped or not being shown
         if(!be_window->show || !be_window->mapped)
             continue;
@@ -222,8 +395,8 @@ static void handle_frame(struct wl_listener *l, void *data){
             continue;
 
         struct wlr_box render_box = {
-            .x = be_window->x,
-            .y = be_window->y,
+            .x = be_window->x - ox,
+            .y = be_window->y - oy,
             .width = srfc->current.width,
             .height = srfc->current.height,
         };
@@ -235,7 +408,7 @@ static void handle_frame(struct wl_listener *l, void *data){
 
         struct timespec now;
         clock_gettime(CLOCK_REALTIME, &now);
-        wlr_surface_send_frame_done(srfc, &now);
+        send_frame_done(be_window, &now);
     }
 
     // show software cursor if hardware cursor is not working
@@ -257,6 +430,18 @@ static be_screen_t *be_screen_new(backend_t *be, struct wlr_output *output){
     be_screen->be = be;
     be_screen->output = output;
 
+    // prefer the monitor's own identity, or else fall back to the connector
+    if(output->make[0] || output->model[0] || output->serial[0]){
+        snprintf(be_screen->id, sizeof(be_screen->id), "%s/%s/%s",
+                 output->make, output->model, output->serial);
+    }else{
+        snprintf(be_screen->id, sizeof(be_screen->id), "%s", output->name);
+    }
+    // keep it to a single word
+    for(char *c = be_screen->id; *c; c++){
+        if(isspace((unsigned char)*c)) *c = '_';
+    }
+
     // set mode, for backends with modes (the last mode is typically best)
     if(!wl_list_empty(&output->modes)){
         struct wlr_output_mode *mode;
@@ -281,9 +466,12 @@ static be_screen_t *be_screen_new(backend_t *be, struct wlr_output *output){
 
     // TODO: handle resize/move events?
 
+    // place the output to the right of the existing outputs
+    wlr_output_layout_add_auto(be->output_layout, output);
+
     // call venowm's new screen handler and get cb_data
     if(handle_screen_new(be_screen, &be_screen->cb_data)){
-        goto cu_listeners;
+        goto cu_layout;
     }
 
     // create a global.  Not honestly sure what this is good for.
@@ -294,7 +482,9 @@ static be_screen_t *be_screen_new(backend_t *be, struct wlr_output *output){
 
     return be_screen;
 
-cu_listeners:
+cu_layout:
+    wlr_output_layout_remove(be->output_layout, output);
+//cu_listeners:
     wl_list_remove(&be_screen->frame_listener.link);
     wl_list_remove(&be_screen->output_destroyed_listener.link);
     wl_list_remove(&be_screen->link);
@@ -314,9 +504,6 @@ static void handle_new_output(struct wl_listener *l, void *data){
     be_screen_t *be_screen = be_screen_new(be, output);
     if(!be_screen) return;
 
-    // how to handle more than one output?
-    wlr_output_layout_add(be->output_layout, output, 0, 0);
-
     // if this isn't the right scale, load the right scale
     if(output->scale != 1.0){
         wlr_xcursor_manager_load(be->cursor_mgr, output->scale);
@@ -357,11 +544,12 @@ fail:
 
 // returns 0 on success, -1 on error
 int keymap_add_keybinding(keymap_t *keymap, int32_t modded_keysym,
-        bool (*func)(backend_t*, void*), void *data){
+        bool (*func)(backend_t*, void*), void *data, bool repeat){
     // build a binding to be copied into the hashtable
     keybinding_t binding = {
         .func = func,
         .data = data,
+        .repeat = repeat,
     };
 
     // get index
@@ -398,11 +586,16 @@ typedef struct {
     struct wl_listener mod_listener;
     struct wl_listener keyboard_destroyed;
     struct wl_list link; // backend_t.keyboards
+    // key repeat for bindings (clients do their own key repeat)
+    struct wl_event_source *repeat_timer;
+    keybinding_t repeat_binding;
+    xkb_keycode_t repeat_keycode;
 } keyboard_t;
 
-// return "true" to consume the keybinding
+/* return "true" to consume the keybinding; the binding that was called is
+   written to *called */
 static bool keymap_filter_keysyms(keymap_t *keymap, uint32_t mods,
-        const xkb_keysym_t *keysyms, size_t nkeysyms){
+        const xkb_keysym_t *keysyms, size_t nkeysyms, keybinding_t *called){
     for(size_t i = 0; i < nkeysyms; i++){
         int32_t modded_keysym = keysyms[i];
         // capture modifiers we care about
@@ -416,6 +609,7 @@ static bool keymap_filter_keysyms(keymap_t *keymap, uint32_t mods,
         if(!binding.func) continue;
 
         // call the first keybinding
+        *called = binding;
         return binding.func(keymap->be, binding.data);
     }
     return false;
@@ -423,7 +617,7 @@ static bool keymap_filter_keysyms(keymap_t *keymap, uint32_t mods,
 
 // return "true" to consume the keybinding
 static bool keymap_filter_keycode(backend_t *be, struct wlr_keyboard *k,
-        xkb_keycode_t keycode){
+        xkb_keycode_t keycode, keybinding_t *called){
     uint32_t modifiers;
     const xkb_keysym_t *keysyms;
     size_t nkeysyms;
@@ -439,7 +633,8 @@ static bool keymap_filter_keycode(backend_t *be, struct wlr_keyboard *k,
     // get syms
     nkeysyms = xkb_state_key_get_syms(k->xkb_state, keycode, &keysyms);
     // check it against the keymap
-    if(keymap_filter_keysyms(be->keymap_top, modifiers, keysyms, nkeysyms)){
+    if(keymap_filter_keysyms(be->keymap_top, modifiers, keysyms, nkeysyms,
+                called)){
         return true;
     }
 
@@ -450,13 +645,34 @@ static bool keymap_filter_keycode(backend_t *be, struct wlr_keyboard *k,
             keycode);
     nkeysyms = xkb_keymap_key_get_syms_by_level(k->keymap, keycode,
             layout_index, 0, &keysyms);
-    if(keymap_filter_keysyms(be->keymap_top, modifiers, keysyms, nkeysyms)){
+    if(keymap_filter_keysyms(be->keymap_top, modifiers, keysyms, nkeysyms,
+                called)){
         return true;
     }
 
     return false;
 }
 
+static void keyboard_stop_repeat(keyboard_t *kbd){
+    kbd->repeat_binding = KEYBINDING_NONE;
+    kbd->repeat_keycode = 0;
+    wl_event_source_timer_update(kbd->repeat_timer, 0);
+}
+
+static int handle_repeat_timer(void *data){
+    keyboard_t *kbd = data;
+    struct wlr_keyboard *k = kbd->device->keyboard;
+    keybinding_t binding = kbd->repeat_binding;
+
+    if(!binding.func || k->repeat_info.rate <= 0) return 0;
+
+    // arm the timer before calling the binding, in case the binding stops it
+    wl_event_source_timer_update(kbd->repeat_timer,
+            1000 / k->repeat_info.rate);
+    binding.func(kbd->be, binding.data);
+    return 0;
+}
+
 
 static void handle_key(struct wl_listener *l, void *data){
     keyboard_t *kbd = wl_container_of(l, kbd, key_listener);
@@ -467,9 +683,20 @@ static void handle_key(struct wl_listener *l, void *data){
     xkb_keycode_t keycode = event->keycode + 8;
 
     if(event->state == WLR_KEY_PRESSED){
-        if(keymap_filter_keycode(be, k, keycode)){
+        // any new keypress ends the repeating
+        keyboard_stop_repeat(kbd);
+        keybinding_t called = KEYBINDING_NONE;
+        if(keymap_filter_keycode(be, k, keycode, &called)){
+            if(called.repeat && k->repeat_info.delay > 0){
+                kbd->repeat_binding = called;
+                kbd->repeat_keycode = keycode;
+                wl_event_source_timer_update(kbd->repeat_timer,
+                        k->repeat_info.delay);
+            }
             return;
         }
+    }else if(keycode == kbd->repeat_keycode){
+        keyboard_stop_repeat(kbd);
     }
 
     // wlr_seat_set_keyboard() is a noop if this keyboard is already set
@@ -501,6 +728,8 @@ static void keyboard_destroyed(struct wl_listener *l, void *data){
     // remove from backend list
     wl_list_remove(&kbd->link);
 
+    wl_event_source_remove(kbd->repeat_timer);
+
     if(wl_list_empty(&be->keyboards)
             && (be->seat_caps & WL_SEAT_CAPABILITY_KEYBOARD)){
         be->seat_caps &= ~WL_SEAT_CAPABILITY_KEYBOARD;
@@ -551,6 +780,10 @@ static keyboard_t *keyboard_new(backend_t *be,
     wlr_keyboard_set_keymap(device->keyboard, xkb_keymap);
     wlr_keyboard_set_repeat_info(device->keyboard, 40, 200);
 
+    kbd->repeat_timer = wl_event_loop_add_timer(be->loop, handle_repeat_timer,
+            kbd);
+    if(!kbd->repeat_timer) goto fail;
+
     kbd->key_listener.notify = handle_key;
     wl_signal_add(&device->keyboard->events.key, &kbd->key_listener);
 
@@ -589,9 +822,17 @@ typedef struct {
 
 static void handle_button(struct wl_listener *l, void *data){
     pointer_t *ptr = wl_container_of(l, ptr, button_listener);
-    struct wlr_event_mouse_button *event = data;
-    (void)event; (void)ptr;
+    struct wlr_event_pointer_button *event = data;
+    backend_t *be = ptr->be;
     // logmsg("button\n");
+
+    if(event->state == WLR_BUTTON_PRESSED){
+        // call hook into venowm
+        handle_pointer_press((int32_t)be->cursor->x, (int32_t)be->cursor->y);
+    }else{
+        handle_pointer_release((int32_t)be->cursor->x,
+                (int32_t)be->cursor->y);
+    }
 }
 
 static void handle_motion(struct wl_listener *l, void *data){
@@ -601,6 +842,9 @@ static void handle_motion(struct wl_listener *l, void *data){
     // logmsg("motion\n");
 
     wlr_cursor_move(be->cursor, event->device, event->delta_x, event->delta_y);
+
+    // call hook into venowm
+    handle_pointer_motion((int32_t)be->cursor->x, (int32_t)be->cursor->y);
 }
 
 static void handle_motion_abs(struct wl_listener *l, void *data){
@@ -620,6 +864,9 @@ static void handle_motion_abs(struct wl_listener *l, void *data){
     //     event->x, event->y, x, y);
 
     wlr_cursor_warp_closest(be->cursor, event->device, x, y);
+
+    // call hook into venowm
+    handle_pointer_motion((int32_t)be->cursor->x, (int32_t)be->cursor->y);
 }
 
 static void pointer_destroyed(struct wl_listener *l, void *data){
@@ -710,9 +957,172 @@ static void handle_new_input_device(struct wl_listener *l, void *data){
 
 ///// Backend Window Functions
 
+static void lru_remove(be_window_t *be_window){
+    if(!be_window->in_lru) return;
+    wl_list_remove(&be_window->lru_link);
+    be_window->in_lru = false;
+}
+
+// the most recently hidden window goes last
+static void lru_append(be_window_t *be_window){
+    lru_remove(be_window);
+    wl_list_insert(be_window->be->lru.prev, &be_window->lru_link);
+    be_window->in_lru = true;
+}
+
+/* The texture belongs to wlroots, so the way to be rid of it is to have the
+   client replace it with a tiny one.  The window keeps pending_w and
+   pending_h, which be_window_show() sends again.  That is a real change of
+   size, so the client always draws a fresh frame for it. */
+static void be_window_evict(be_window_t *be_window){
+    lru_remove(be_window);
+    logmsg("evicting texture of %zu bytes\n", be_window->texture_bytes);
+    wlr_xdg_toplevel_set_size(be_window->xdg_surface, EVICT_SIZE, EVICT_SIZE);
+    be_window->evicted = true;
+}
+
+// can the window be evicted right now?
+static bool evictable(be_window_t *be_window, uint64_t now){
+    struct wlr_xdg_surface *xdg_surface = be_window->xdg_surface;
+    if(xdg_surface->role != WLR_XDG_SURFACE_ROLE_TOPLEVEL) return false;
+    // a window which is drawing would only draw again at the tiny size
+    if(now - be_window->last_commit_us < EVICT_IDLE_MS * 1000) return false;
+    // it would never shrink
+    if(be_window->unresponsive) return false;
+    // the size can't be sent until the last one is acked
+    if(xdg_surface->configure_idle
+            || !wl_list_empty(&xdg_surface->configure_list)){
+        return false;
+    }
+    return true;
+}
+
+static int handle_evict_timer(void *data){
+    backend_t *be = data;
+    be->evict_armed = false;
+    uint64_t now = now_us();
+    bool skipped = false;
+    be_window_t *be_window;
+    be_window_t *temp;
+    wl_list_for_each_safe(be_window, temp, &be->lru, lru_link){
+        if(be->texture_bytes <= be->texture_budget) return 0;
+        if(!evictable(be_window, now)){
+            skipped = true;
+            continue;
+        }
+        be_window_evict(be_window);
+    }
+    // try the busy ones again later
+    if(skipped && be->texture_bytes > be->texture_budget){
+        wl_event_source_timer_update(be->evict_timer, EVICT_IDLE_MS);
+        be->evict_armed = true;
+    }
+    return 0;
+}
+
+/* Evictions happen on a timer, so a burst of commits costs one pass over
+   the hidden windows, and windows have time to go quiet. */
+static void enforce_texture_budget(backend_t *be){
+    if(!be->texture_budget || be->texture_bytes <= be->texture_budget) return;
+    if(be->evict_armed || wl_list_empty(&be->lru)) return;
+    wl_event_source_timer_update(be->evict_timer, EVICT_IDLE_MS);
+    be->evict_armed = true;
+}
+
+static void handle_wlr_surface_commit(struct wl_listener *l, void *data){
+    (void)data;
+    be_window_t *be_window = wl_container_of(l, be_window, wlr_surface_commit);
+    backend_t *be = be_window->be;
+    struct wlr_texture *texture;
+    texture = wlr_surface_get_texture(be_window->wlr_surface);
+    size_t bytes = 0;
+    if(texture){
+        int w, h;
+        wlr_texture_get_size(texture, &w, &h);
+        // assume 4 bytes per pixel, which is what nearly everything uses
+        bytes = (size_t)w * (size_t)h * 4;
+    }
+    be->texture_bytes -= be_window->texture_bytes;
+    be->texture_bytes += bytes;
+
+    // before the toplevel's first configure goes out
+    struct wlr_xdg_surface *xdg_surface = be_window->xdg_surface;
+    if(!be_window->planned && xdg_surface && !xdg_surface->configured
+            && xdg_surface->role == WLR_XDG_SURFACE_ROLE_TOPLEVEL){
+        plan_window(be_window);
+    }
+
+    client_t *client = be_window->client;
+    if(client){
+        uint64_t us = now_us();
+        rate_tick(&client->commits, us);
+        client->buffer_bytes -= be_window->texture_bytes;
+        client->buffer_bytes += bytes;
+        // the first commit after the client acked our last size
+        if(be_window->configure_sent_us && xdg_surface
+                && !xdg_surface->configure_idle
+                && wl_list_empty(&xdg_surface->configure_list)){
+            uint64_t took = us - be_window->configure_sent_us;
+            client->configures++;
+            client->configure_total_us += took;
+            if(took > client->configure_max_us){
+                client->configure_max_us = (uint32_t)took;
+            }
+            be_window->configure_sent_us = 0;
+        }
+    }
+    be_window->texture_bytes = bytes;
+    be_window->last_commit_us = now_us();
+    // a hidden window can still draw, so it may be the one over budget
+    if(bytes && be_window->mapped && !be_window->show && !be_window->in_lru
+            && !be_window->evicted){
+        lru_append(be_window);
+    }
+    enforce_texture_budget(be);
+}
+
+static void handle_client_destroyed(struct wl_listener *l, void *data){
+    (void)data;
+    client_t *client = wl_container_of(l, client, destroyed);
+    wl_list_remove(&client->destroyed.link);
+    wl_list_remove(&client->link);
+    client->gone = true;
+    // its surfaces are destroyed next, and the last one frees the client
+    if(!client->surfaces) free(client);
+}
+
+// returns NULL if there's no memory, then the client just isn't counted
+static client_t *client_get(backend_t *be, struct wl_client *wl_client){
+    struct wl_listener *l;
+    l = wl_client_get_destroy_listener(wl_client, handle_client_destroyed);
+    if(l){
+        client_t *client = wl_container_of(l, client, destroyed);
+        return client;
+    }
+    client_t *client = malloc(sizeof(*client));
+    if(!client) return NULL;
+    *client = (client_t){.wl_client = wl_client};
+    client->destroyed.notify = handle_client_destroyed;
+    wl_client_add_destroy_listener(wl_client, &client->destroyed);
+    wl_list_insert(be->clients.prev, &client->link);
+    return client;
+}
+
 static void be_window_free(be_window_t *be_window){
     // don't need to remove destroy handlers
-    free(be_window);
+    be_window->be->texture_bytes -= be_window->texture_bytes;
+    client_t *client = be_window->client;
+    if(client){
+        client->buffer_bytes -= be_window->texture_bytes;
+        if(client->named == be_window) client->named = NULL;
+        if(--client->surfaces == 0 && client->gone) free(client);
+    }
+    lru_remove(be_window);
+    if(be_window->props_dirty) wl_list_remove(&be_window->props_link);
+    if(be_window->close_timer) wl_event_source_remove(be_window->close_timer);
+    free(be_window->title);
+    free(be_window->app_id);
+    slab_free(be_window);
 }
 
 static void handle_wlr_surface_destroyed(struct wl_listener *l, void *data){
@@ -725,17 +1135,24 @@ static void handle_wlr_surface_destroyed(struct wl_listener *l, void *data){
 
 static be_window_t *be_window_new(backend_t *be,
                                   struct wlr_surface *wlr_surface){
-    be_window_t *be_window = malloc(sizeof(*be_window));
+    be_window_t *be_window = slab_alloc(&be->window_slab);
     if(!be_window) return NULL;
     *be_window = (be_window_t){0};
 
     be_window->be = be;
     be_window->wlr_surface = wlr_surface;
+    be_window->client = client_get(be,
+            wl_resource_get_client(wlr_surface->resource));
+    if(be_window->client) be_window->client->surfaces++;
 
     // add destroy handler
     be_window->wlr_surface_destroyed.notify = handle_wlr_surface_destroyed;
     wl_signal_add(&wlr_surface->events.destroy,
                   &be_window->wlr_surface_destroyed);
+    // keep track of the texture's size
+    be_window->wlr_surface_commit.notify = handle_wlr_surface_commit;
+    wl_signal_add(&wlr_surface->events.commit,
+                  &be_window->wlr_surface_commit);
 
     return be_window;
 }
@@ -757,6 +1174,26 @@ static void handle_xdg_destroyed(struct wl_listener *l, void *data){
     be_window_t *be_window = wl_container_of(l, be_window, xdg_destroyed);
     backend_t *be = be_window->be;
 
+    if(be_window->props_listening){
+        wl_list_remove(&be_window->set_title.link);
+        wl_list_remove(&be_window->set_app_id.link);
+        be_window->props_listening = false;
+    }
+    if(be_window->props_dirty){
+        wl_list_remove(&be_window->props_link);
+        be_window->props_dirty = false;
+    }
+    wl_list_remove(&be_window->ping_timeout.link);
+    // it never mapped
+    handle_window_plan_drop(be_window->plan);
+    be_window->plan = NULL;
+    be_window->planned = false;
+    // it closed after all
+    if(be_window->close_timer){
+        wl_event_source_remove(be_window->close_timer);
+        be_window->close_timer = NULL;
+    }
+
     // remove focus if it had focus
     if(be->focus == be_window){
         // point keyboard at nothing
@@ -766,24 +1203,186 @@ static void handle_xdg_destroyed(struct wl_listener *l, void *data){
     }
 }
 
+static void handle_ping_timeout(struct wl_listener *l, void *data){
+    be_window_t *be_window = wl_container_of(l, be_window, ping_timeout);
+    be_window->ping_outstanding = false;
+    if(be_window->unresponsive) return;
+    logmsg("window %p is not responding\n", (void*)be_window);
+    be_window->unresponsive = true;
+}
+
+// pings go to the client, so every window of the client waits for the pong
+static void ping_client(struct wlr_xdg_client *client){
+    if(wl_list_empty(&client->surfaces)) return;
+    struct wlr_xdg_surface *xdg_surface;
+    wl_list_for_each(xdg_surface, &client->surfaces, link){
+        be_window_t *be_window = xdg_surface->surface->data;
+        if(be_window) be_window->ping_outstanding = true;
+    }
+    // any one of its surfaces will do
+    xdg_surface = wl_container_of(client->surfaces.next, xdg_surface, link);
+    wlr_xdg_surface_ping(xdg_surface);
+}
+
+static void set_responsive(be_window_t *be_window){
+    logmsg("window %p is responding again\n", (void*)be_window);
+    be_window->unresponsive = false;
+    // it gets the size it missed
+    if(be_window->size_pending) be_window_send_size(be_window);
+}
+
+static int handle_ping_timer(void *data){
+    backend_t *be = data;
+    struct wlr_xdg_client *client;
+    wl_list_for_each(client, &be->xdg_shell->clients, link){
+        /* wlroots clears the serial on a pong or a timeout, and a timeout
+           clears ping_outstanding too, so only a pong leaves it set */
+        if(client->ping_serial == 0){
+            struct wlr_xdg_surface *xdg_surface;
+            wl_list_for_each(xdg_surface, &client->surfaces, link){
+                be_window_t *be_window = xdg_surface->surface->data;
+                if(!be_window || !be_window->ping_outstanding) continue;
+                be_window->ping_outstanding = false;
+                if(be_window->unresponsive) set_responsive(be_window);
+            }
+        }
+        ping_client(client);
+    }
+    wl_event_source_timer_update(be->ping_timer, PING_INTERVAL_MS);
+    return 0;
+}
+
+// copy a string if it changed, returns true if it did
+static bool update_prop(char **cache, const char *val){
+    if(!val && !*cache) return false;
+    if(val && *cache && strcmp(val, *cache) == 0) return false;
+    char *copy = val ? strdup(val) : NULL;
+    // without memory, keep the old value rather than none
+    if(val && !copy) return false;
+    free(*cache);
+    *cache = copy;
+    return true;
+}
+
+// returns true if the title or app_id changed
+static bool refresh_props(be_window_t *be_window){
+    struct wlr_xdg_surface *xdg_surface = be_window->xdg_surface;
+    if(!xdg_surface || xdg_surface->role != WLR_XDG_SURFACE_ROLE_TOPLEVEL){
+        return false;
+    }
+    struct wlr_xdg_toplevel *toplevel = xdg_surface->toplevel;
+    bool changed = update_prop(&be_window->title, toplevel->title);
+    changed |= update_prop(&be_window->app_id, toplevel->app_id);
+    return changed;
+}
+
+/* Venowm picks where a toplevel goes at its first commit, so that the first
+   configure, which wlroots sends at idle, already has the size of its frame.
+   Otherwise the client draws its first frame at a size of its own, only to
+   be resized as soon as it maps.  A window which maps without that is only
+   placed, and it is sized when it is drawn. */
+static void plan_window(be_window_t *be_window){
+    struct wlr_xdg_surface *xdg_surface = be_window->xdg_surface;
+    // the title and app_id are usually set before the first commit
+    refresh_props(be_window);
+    uint32_t w = 0, h = 0;
+    be_window->plan = handle_window_plan(be_window, &w, &h);
+    be_window->planned = true;
+    if(!w || !h || be_window->mapped || xdg_surface->configured) return;
+    wlr_xdg_toplevel_set_size(xdg_surface, w, h);
+    // be_window_geometry() won't send it again when the window maps
+    be_window->pending_w = w;
+    be_window->pending_h = h;
+    be_window->sized = true;
+    be_window->configure_sent_us = now_us();
+}
+
+static int handle_props_timer(void *data){
+    backend_t *be = data;
+    be->props_armed = false;
+    be_window_t *be_window;
+    be_window_t *temp;
+    wl_list_for_each_safe(be_window, temp, &be->props_dirty, props_link){
+        wl_list_remove(&be_window->props_link);
+        be_window->props_dirty = false;
+        // nobody to tell if venowm doesn't know about the window right now
+        if(!be_window->mapped || !be_window->venowm_data) continue;
+        // often the title is set back to what it was
+        if(refresh_props(be_window)){
+            handle_window_props(be_window->venowm_data);
+        }
+    }
+    return 0;
+}
+
+static void handle_toplevel_props(be_window_t *be_window){
+    backend_t *be = be_window->be;
+    if(!be_window->props_dirty){
+        wl_list_insert(&be->props_dirty, &be_window->props_link);
+        be_window->props_dirty = true;
+    }
+    // changes until the timer fires are all handled at once
+    if(!be->props_armed){
+        wl_event_source_timer_update(be->props_timer, PROPS_DELAY_MS);
+        be->props_armed = true;
+    }
+}
+
+static void handle_set_title(struct wl_listener *l, void *data){
+    be_window_t *be_window = wl_container_of(l, be_window, set_title);
+    handle_toplevel_props(be_window);
+}
+
+static void handle_set_app_id(struct wl_listener *l, void *data){
+    be_window_t *be_window = wl_container_of(l, be_window, set_app_id);
+    handle_toplevel_props(be_window);
+}
+
 static void handle_xdg_mapped(struct wl_listener *l, void *data){
     be_window_t *be_window = wl_container_of(l, be_window, xdg_mapped);
+    struct wlr_xdg_surface *xdg_surface = be_window->xdg_surface;
 
     be_window->mapped = true;
 
     logmsg("xdg mapped\n");
 
     // set XDG to be fully tiled
-    wlr_xdg_toplevel_set_tiled(be_window->xdg_surface, 15);
-
-    // call hook into venowm
-    handle_window_new(be_window, &be_window->venowm_data);
+    wlr_xdg_toplevel_set_tiled(xdg_surface, 15);
+
+    // the role is known by now, so the toplevel's events are too
+    if(!be_window->props_listening
+            && xdg_surface->role == WLR_XDG_SURFACE_ROLE_TOPLEVEL){
+        struct wlr_xdg_toplevel *toplevel = xdg_surface->toplevel;
+        be_window->set_title.notify = handle_set_title;
+        wl_signal_add(&toplevel->events.set_title, &be_window->set_title);
+        be_window->set_app_id.notify = handle_set_app_id;
+        wl_signal_add(&toplevel->events.set_app_id, &be_window->set_app_id);
+        be_window->props_listening = true;
+    }
+    // venowm sees the properties the window was mapped with right away
+    refresh_props(be_window);
+    client_t *client = be_window->client;
+    if(client && !client->named) client->named = be_window;
+
+    // a window which mapped without us seeing its first commit
+    if(!be_window->planned) plan_window(be_window);
+    // call hook into venowm, which takes the plan
+    handle_window_new(be_window, be_window->plan, &be_window->venowm_data);
+    be_window->plan = NULL;
+
+    // a window placed out of sight is as good as hidden
+    if(!be_window->show){
+        lru_append(be_window);
+        enforce_texture_budget(be_window->be);
+    }
 }
 
 static void handle_xdg_unmapped(struct wl_listener *l, void *data){
     be_window_t *be_window = wl_container_of(l, be_window, xdg_unmapped);
 
     be_window->mapped = false;
+    // it gets a new plan if it maps again
+    be_window->planned = false;
 
     logmsg("xdg unmapped\n");
 
@@ -835,8 +1434,15 @@ static void handle_xdg_shell_new(struct wl_listener *l, void *data){
     be_window->xdg_unmapped.notify = handle_xdg_unmapped;
     wl_signal_add(&xdg_surface->events.unmap, &be_window->xdg_unmapped);
 
+    be_window->ping_timeout.notify = handle_ping_timeout;
+    wl_signal_add(&xdg_surface->events.ping_timeout,
+                  &be_window->ping_timeout);
+
     // initial state
     be_window->mapped = false;
+    be_window->props_listening = false;
+    be_window->plan = NULL;
+    be_window->planned = false;
 
     // don't call into venowm until the surface is mapped
 }
@@ -900,7 +1506,11 @@ void backend_free(backend_t *be){
     wlr_output_layout_destroy(be->output_layout);
     wl_list_remove(&be->new_output_listener.link);
     wlr_backend_destroy(be->wlr_backend);
+    wl_event_source_remove(be->ping_timer);
+    wl_event_source_remove(be->props_timer);
+    wl_event_source_remove(be->evict_timer);
     wl_display_destroy(be->display);
+    slab_deinit(&be->window_slab);
     free(be);
 }
 
@@ -914,12 +1524,26 @@ backend_t *backend_new(void){
     if(!be) return NULL;
     *be = (backend_t){0};
 
+    slab_init(&be->window_slab, &be_window_slab_type);
+
     be->display = wl_display_create();
     if(!be->display) goto fail_be;
 
     be->loop = wl_display_get_event_loop(be->display);
     if(!be->loop) goto fail_display;
 
+    wl_list_init(&be->props_dirty);
+    wl_list_init(&be->lru);
+    wl_list_init(&be->clients);
+    be->props_timer = wl_event_loop_add_timer(be->loop, handle_props_timer,
+                                              be);
+    if(!be->props_timer) goto fail_display;
+    be->ping_timer = wl_event_loop_add_timer(be->loop, handle_ping_timer, be);
+    if(!be->ping_timer) goto fail_display;
+    be->evict_timer = wl_event_loop_add_timer(be->loop, handle_evict_timer,
+                                              be);
+    if(!be->evict_timer) goto fail_display;
+
     // get the wayland backend
     be->wlr_backend = wlr_backend_autocreate(be->display, NULL);
     if(!be->wlr_backend) goto fail_display;
@@ -1049,6 +1673,9 @@ fail_wlr_backend:
     wl_list_remove(&be->new_output_listener.link);
     wlr_backend_destroy(be->wlr_backend);
 fail_display:
+    if(be->ping_timer) wl_event_source_remove(be->ping_timer);
+    if(be->props_timer) wl_event_source_remove(be->props_timer);
+    if(be->evict_timer) wl_event_source_remove(be->evict_timer);
     wl_display_destroy(be->display);
 fail_be:
     free(be);
@@ -1062,6 +1689,9 @@ int backend_run(backend_t *be){
 
     setenv("WAYLAND_DISPLAY", be->socket, true);
 
+    // start looking out for hung clients
+    wl_event_source_timer_update(be->ping_timer, PING_INTERVAL_MS);
+
     // exec("weston-info > wifo");
     exec("weston-terminal");
 
@@ -1075,7 +1705,7 @@ void backend_stop(backend_t *be){
 }
 
 int be_handle_key(backend_t *be, uint32_t mods, uint32_t key,
-        bool (*func)(backend_t*, void*), void *data){
+        bool (*func)(backend_t*, void*), void *data, bool repeat){
     // get the modded_key for the hashtable
     uint32_t modded_keysym = (uint32_t)key;
     if(mods & MOD_CTRL)     modded_keysym |= BE_MOD_CTRL;
@@ -1084,7 +1714,8 @@ int be_handle_key(backend_t *be, uint32_t mods, uint32_t key,
     if(mods & MOD_SUPER)    modded_keysym |= BE_MOD_SUPER;
 
     int ret;
-    ret = keymap_add_keybinding(be->keymap_top, modded_keysym, func, data);
+    ret = keymap_add_keybinding(be->keymap_top, modded_keysym, func, data,
+            repeat);
     if(ret < 0){
         return -1;
     }
@@ -1094,12 +1725,19 @@ int be_handle_key(backend_t *be, uint32_t mods, uint32_t key,
 
 void be_screen_get_geometry(be_screen_t *be_screen, int32_t *x, int32_t *y,
         uint32_t *w, uint32_t *h){
-    *x = 0;
-    *y = 0;
+    // report the position within the output layout
+    struct wlr_box *box = wlr_output_layout_get_box(
+            be_screen->be->output_layout, be_screen->output);
+    *x = box ? box->x : 0;
+    *y = box ? box->y : 0;
     *w = (uint32_t)be_screen->output->width;
     *h = (uint32_t)be_screen->output->height;
 }
 
+const char *be_screen_get_id(be_screen_t *be_screen){
+    return be_screen->id;
+}
+
 void be_unfocus_all(backend_t *be){
     if(be->focus != NULL){
         // deactivate surface
@@ -1113,6 +1751,8 @@ void be_unfocus_all(backend_t *be){
 
 void be_window_focus(be_window_t *be_window){
     backend_t *be = be_window->be;
+    // don't send the client another enter and activate for nothing
+    if(be->focus == be_window) return;
     if(be->focus != NULL){
         // deactivate old surface
         wlr_xdg_toplevel_set_activated(be->focus->xdg_surface, false);
@@ -1137,10 +1777,17 @@ void be_window_hide(be_window_t *be_window){
     if(!be_window->show) return;
     be_window->show = false;
     wl_list_remove(&be_window->link);
+    // no more frames from that screen, so don't wait for one
+    be_window->configured_this_frame = false;
     // if the window was focused, unfocus it
     if(be->focus == be_window){
         be_unfocus_all(be);
     }
+    // only windows which are mapped are worth evicting
+    if(be_window->mapped && !be_window->evicted){
+        lru_append(be_window);
+        enforce_texture_budget(be);
+    }
 }
 
 void be_window_show(be_window_t *be_window, be_screen_t *be_screen){
@@ -1148,20 +1795,174 @@ void be_window_show(be_window_t *be_window, be_screen_t *be_screen){
     be_window->show = true;
     // add this window to that screen
     wl_list_insert(be_screen->windows.prev, &be_window->link);
+    lru_remove(be_window);
+    // an evicted window gets its real size back, during the next frame
+    if(be_window->evicted) be_window->size_pending = true;
+}
+
+const char *be_window_get_app_id(be_window_t *be_window){
+    return be_window->app_id;
+}
+
+const char *be_window_get_title(be_window_t *be_window){
+    return be_window->title;
+}
+
+pid_t be_window_get_pid(be_window_t *be_window){
+    struct wlr_xdg_surface *xdg_surface = be_window->xdg_surface;
+    if(!xdg_surface || !xdg_surface->resource) return 0;
+    struct wl_client *client = wl_resource_get_client(xdg_surface->resource);
+    pid_t pid = 0;
+    wl_client_get_credentials(client, &pid, NULL, NULL);
+    return pid;
+}
+
+/* The window was asked to close and it's still here.  An application may
+   be asking the user about unsaved work, so it's only killed if it has also
+   stopped answering pings. */
+static int handle_close_timer(void *data){
+    be_window_t *be_window = data;
+    if(!be_window->unresponsive) return 0;
+    pid_t pid = be_window_get_pid(be_window);
+    if(pid <= 1 || pid == getpid()) return 0;
+    if(!be_window->sent_sigterm){
+        logmsg("window %p is hung, sending SIGTERM to %d\n",
+               (void*)be_window, (int)pid);
+        kill(pid, SIGTERM);
+        be_window->sent_sigterm = true;
+        wl_event_source_timer_update(be_window->close_timer, KILL_DELAY_MS);
+        return 0;
+    }
+    logmsg("window %p is still hung, sending SIGKILL to %d\n",
+           (void*)be_window, (int)pid);
+    kill(pid, SIGKILL);
+    return 0;
 }
 
 void be_window_close(be_window_t *be_window){
+    backend_t *be = be_window->be;
     wlr_xdg_toplevel_send_close(be_window->xdg_surface);
     // TODO: handle popups as well
+    if(!be->kill_hung) return;
+    // find out if it's hung by the time the close times out
+    ping_client(be_window->xdg_surface->client);
+    if(!be_window->close_timer){
+        be_window->close_timer = wl_event_loop_add_timer(be->loop,
+                handle_close_timer, be_window);
+        if(!be_window->close_timer) return;
+    }
+    be_window->sent_sigterm = false;
+    // long enough for a ping to time out
+    wl_event_source_timer_update(be_window->close_timer,
+            (int)be->xdg_shell->ping_timeout + KILL_DELAY_MS);
+}
+
+void be_set_hung_policy(backend_t *be, uint32_t ping_timeout_ms,
+                        bool kill_hung){
+    if(ping_timeout_ms) be->xdg_shell->ping_timeout = ping_timeout_ms;
+    be->kill_hung = kill_hung;
+}
+
+void be_client_stats(backend_t *be, be_client_stats_cb_t cb, void *data){
+    uint64_t sec = now_us() / 1000000;
+    client_t *client;
+    wl_list_for_each(client, &be->clients, link){
+        rate_roll(&client->commits, (time_t)sec);
+        rate_roll(&client->frames, (time_t)sec);
+        be_client_stats_t stats = {
+            .surfaces = client->surfaces,
+            .buffer_bytes = client->buffer_bytes,
+            .commits_per_sec = client->commits.last_sec,
+            .frames_per_sec = client->frames.last_sec,
+            .configure_max_us = client->configure_max_us,
+        };
+        wl_client_get_credentials(client->wl_client, &stats.pid, NULL, NULL);
+        if(client->named) stats.app_id = client->named->app_id;
+        if(client->configures){
+            stats.configure_avg_us =
+                (uint32_t)(client->configure_total_us / client->configures);
+        }
+        cb(data, &stats);
+    }
+}
+
+void be_set_texture_budget(backend_t *be, size_t bytes){
+    be->texture_budget = bytes;
+    enforce_texture_budget(be);
+}
+
+// send the pending size, unless a configure is still waiting for an ack
+static void be_window_send_size(be_window_t *be_window){
+    struct wlr_xdg_surface *xdg_surface = be_window->xdg_surface;
+    // a hung client would never ack it, it waits until the client is back
+    if(be_window->unresponsive) return;
+    if(xdg_surface->configure_idle
+            || !wl_list_empty(&xdg_surface->configure_list)){
+        // try again next frame
+        return;
+    }
+    uint32_t serial = wlr_xdg_toplevel_set_size(xdg_surface,
+            be_window->pending_w, be_window->pending_h);
+    be_window->size_pending = false;
+    be_window->configured_this_frame = true;
+    be_window->evicted = false;
+    // the latency counts from the first size the client hasn't drawn yet
+    if(!be_window->configure_sent_us) be_window->configure_sent_us = now_us();
+    logmsg("set_size serial is %u\n", serial);
 }
 
 void be_window_geometry(be_window_t *be_window, int32_t x, int32_t y,
         uint32_t w, uint32_t h){
-    uint32_t serial = wlr_xdg_toplevel_set_size(be_window->xdg_surface, w, h);
+    // the position is ours, so it changes right away
     be_window->x = x; be_window->y = y;
-    logmsg("set_size serial is %u\n", serial);
+    // don't bother the application if the size isn't changing
+    if(be_window->sized && w == be_window->pending_w
+            && h == be_window->pending_h){
+        return;
+    }
+    be_window->sized = true;
+    // the size has to go through the application
+    be_window->pending_w = w;
+    be_window->pending_h = h;
+    be_window->size_pending = true;
+    // otherwise the size is sent during the next frame
+    if(!be_window->configured_this_frame) be_window_send_size(be_window);
 }
 
 // request an explicit repaint
 void be_repaint(backend_t *be){
 }
+
+struct be_timer_t {
+    struct wl_event_source *source;
+    void (*func)(void*);
+    void *data;
+};
+
+static int handle_timer(void *data){
+    be_timer_t *timer = data;
+    timer->func(timer->data);
+    return 0;
+}
+
+be_timer_t *be_timer_new(backend_t *be, void (*func)(void*), void *data){
+    be_timer_t *timer = malloc(sizeof(*timer));
+    if(!timer) return NULL;
+    *timer = (be_timer_t){.func = func, .data = data};
+    timer->source = wl_event_loop_add_timer(be->loop, handle_timer, timer);
+    if(!timer->source){
+        free(timer);
+        return NULL;
+    }
+    return timer;
+}
+
+void be_timer_arm(be_timer_t *timer, uint32_t ms){
+    wl_event_source_timer_update(timer->source, (int)ms);
+}
+
+void be_timer_free(be_timer_t *timer){
+    if(!timer) return;
+    wl_event_source_remove(timer->source);
+    free(timer);
+}
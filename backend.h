@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <time.h>
+#include <sys/types.h>
 
 typedef struct be_screen_t be_screen_t;
 typedef struct be_window_t be_window_t;
@@ -22,23 +23,74 @@ enum {
     MOD_SHIFT = 1 << 3,
 };
 
+// with repeat=true, func is called again and again while the key is held
 int be_handle_key(backend_t *be, uint32_t mods, uint32_t key,
-        bool (*func)(backend_t*, void*), void *data);
+        bool (*func)(backend_t*, void*), void *data, bool repeat);
 
 void be_screen_get_geometry(be_screen_t *be_screen,
                             int32_t *x, int32_t *y, uint32_t *w, uint32_t *h);
+/* a single word naming the monitor (make, model and serial) which stays the
+   same across restarts, or the connector if the monitor doesn't say */
+const char *be_screen_get_id(be_screen_t *be_screen);
 
 void be_unfocus_all(backend_t *be);
 void be_window_focus(be_window_t *be_window);
 void be_window_hide(be_window_t *be_window);
 void be_window_show(be_window_t *be_window, be_screen_t *be_screen);
 void be_window_close(be_window_t *be_window);
+/* Clients are pinged every few seconds, and one which doesn't answer within
+   ping_timeout_ms (0 keeps the default of 10s) is treated as hung until it
+   answers again: it isn't sent any sizes, so nothing waits on it.  With
+   kill_hung, a hung window which doesn't close when asked to is sent SIGTERM
+   and then SIGKILL. */
+void be_set_hung_policy(backend_t *be, uint32_t ping_timeout_ms,
+                        bool kill_hung);
+/* Past this many bytes of textures (0, the default, means no limit), the
+   windows hidden the longest are asked to shrink to their smallest size,
+   which replaces their textures with tiny ones, until it fits.  Windows
+   which are still drawing are left alone.  A shrunk window is sent its real
+   size again when it is shown, so it draws a fresh frame. */
+void be_set_texture_budget(backend_t *be, size_t bytes);
+
+/* What each connected client is costing.  Rates are for the last full
+   second.  The configure latency is from sending a window a size until the
+   client commits a frame after acking it. */
+typedef struct {
+    pid_t pid;
+    // of one of its windows, or NULL
+    const char *app_id;
+    uint32_t surfaces;
+    // about how much its textures take
+    size_t buffer_bytes;
+    uint32_t commits_per_sec;
+    uint32_t frames_per_sec;
+    uint32_t configure_avg_us;
+    uint32_t configure_max_us;
+} be_client_stats_t;
+typedef void (*be_client_stats_cb_t)(void *data,
+        const be_client_stats_t *stats);
+// call cb once per client
+void be_client_stats(backend_t *be, be_client_stats_cb_t cb, void *data);
+
 void be_window_geometry(be_window_t *be_window,
                         int32_t x, int32_t y, uint32_t w, uint32_t h);
+/* what the application calls itself and its window, either may be NULL.
+   These are cached, and only change right before handle_window_props(). */
+const char *be_window_get_app_id(be_window_t *be_window);
+const char *be_window_get_title(be_window_t *be_window);
+// the pid of the client which owns the window, or 0 if it isn't known
+pid_t be_window_get_pid(be_window_t *be_window);
 
 // request an explicit repaint
 void be_repaint(backend_t *be);
 
+/* A one-shot timer on the event loop.  Arming a timer which is already armed
+   pushes it back, so a burst of be_timer_arm() calls ends in one callback. */
+typedef struct be_timer_t be_timer_t;
+be_timer_t *be_timer_new(backend_t *be, void (*func)(void*), void *data);
+void be_timer_arm(be_timer_t *timer, uint32_t ms);
+void be_timer_free(be_timer_t *timer);
+
 //// CALLBACKS TO REST OF THE SYSTEM
 // (not defined in backend.c and must be defined elsewhere)
 
@@ -48,7 +100,22 @@ int handle_screen_new(be_screen_t *be_screen, void **data);
 void handle_screen_geometry(void *data);
 void handle_screen_destroy(void *data);
 
-int handle_window_new(be_window_t *be_window, void **data);
+/* A toplevel's first commit, before its first configure goes out and before
+   it has drawn anything.  Returns where the window is meant to go (or NULL),
+   which is passed to handle_window_new() when it maps, or dropped with
+   handle_window_plan_drop() if it never does.  *w and *h are set to the size
+   the window will get, or left at 0 to let the application pick. */
+void *handle_window_plan(be_window_t *be_window, uint32_t *w, uint32_t *h);
+void handle_window_plan_drop(void *plan);
+int handle_window_new(be_window_t *be_window, void *plan, void **data);
 void handle_window_destroy(void *data);
+/* the window's title or app_id changed.  Called at most once per window per
+   frame or so, no matter how often the application changes them. */
+void handle_window_props(void *data);
+
+// (x,y) is the pointer position in global coordinates
+void handle_pointer_press(int32_t x, int32_t y);
+void handle_pointer_release(int32_t x, int32_t y);
+void handle_pointer_motion(int32_t x, int32_t y);
 
 #endif // BACKEND_H
@@ -0,0 +1,403 @@
+#define _POSIX_C_SOURCE 199309L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "split.h"
+
+/* Randomized property tests and a throughput benchmark for split.c.
+
+   The first half throws random sequences of split, remove, move, swap,
+   resize, only and grid operations at a tree, and checks every invariant
+   after each one.  The second half times get_sides, do_split_move and whole
+   tree traversals at a range of tree sizes.  Run it with `make bench-split`,
+   and keep the numbers from before and after any change to split.c. */
+
+// these are just for the compiler
+static workspace_t ws;
+workspace_t *g_workspace = &ws;
+screen_t **g_screens;
+size_t g_screens_size;
+size_t g_nscreens;
+workspace_t **g_workspaces;
+size_t g_workspaces_size;
+size_t g_nworkspaces;
+//
+
+// size of the pixel grid for checking area coverage
+#define GRID 128
+// fake windows, which live in leaves or are hidden (frame == NULL)
+#define NWINS 64
+// keep the random trees from growing without bound
+#define MAX_LEAVES 200
+
+static ws_win_info_t infos[NWINS];
+
+static int failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if(!(cond)){ \
+        fprintf(stderr, "FAIL %s:%d: ", __FILE__, __LINE__); \
+        fprintf(stderr, __VA_ARGS__); \
+        fprintf(stderr, "\n"); \
+        failures++; \
+        return -1; \
+    } \
+} while(0)
+
+///// Invariants
+
+// parent pointers, indices, orientation and bounds of every node
+static int check_node(split_t *split){
+    if(split->isleaf){
+        CHECK(split->nframes == 0, "leaf with %zu frames", split->nframes);
+        if(split->win_info){
+            CHECK(split->win_info->frame == split, "win_info->frame");
+        }
+        return 0;
+    }
+    CHECK(!split->win_info, "window in a non-leaf");
+    CHECK(split->nframes >= 2, "split with %zu frames", split->nframes);
+    CHECK(split->bounds[0] == 0.0f, "first bound %f", split->bounds[0]);
+    CHECK(split->bounds[split->nframes] == 1.0f, "last bound %f",
+          split->bounds[split->nframes]);
+    for(size_t i = 0; i < split->nframes; i++){
+        split_t *kid = split->frames[i];
+        CHECK(kid->parent == split, "parent pointer of frame %zu", i);
+        CHECK(kid->idx == i, "frame %zu has idx %zu", i, kid->idx);
+        CHECK(split->bounds[i] < split->bounds[i + 1], "bounds not sorted");
+        CHECK(kid->isleaf || kid->isvertical != split->isvertical,
+              "child with the same orientation");
+        if(check_node(kid)) return -1;
+    }
+    return 0;
+}
+
+typedef struct {
+    unsigned char grid[GRID][GRID];
+    split_t **leaves;
+    size_t nleaves;
+    size_t cap;
+} walk_data_t;
+
+static split_walk_t collect_cb(split_t *split, void *data,
+                               float t, float b, float l, float r){
+    walk_data_t *wd = data;
+    if(wd->nleaves == wd->cap){
+        wd->cap = wd->cap ? wd->cap * 2 : 64;
+        wd->leaves = realloc(wd->leaves, sizeof(*wd->leaves) * wd->cap);
+        if(!wd->leaves){
+            perror("realloc");
+            exit(1);
+        }
+    }
+    wd->leaves[wd->nleaves++] = split;
+    // paint the pixels, the same way workspace.c turns fractions to pixels
+    int rt = frac_of(t, GRID + 1), rb = frac_of(b, GRID + 1);
+    int rl = frac_of(l, GRID + 1), rr = frac_of(r, GRID + 1);
+    for(int y = rt; y < rb; y++){
+        for(int x = rl; x < rr; x++){
+            if(wd->grid[y][x] < 255) wd->grid[y][x]++;
+        }
+    }
+    return SPLIT_WALK_CONTINUE;
+}
+
+static walk_data_t wd;
+
+static int check_tree(split_t *root){
+    CHECK(!root->parent, "root has a parent");
+    if(check_node(root)) return -1;
+
+    // leaves, in traversal order
+    memset(wd.grid, 0, sizeof(wd.grid));
+    wd.nleaves = 0;
+    CHECK(split_walk(root, collect_cb, &wd, SPLIT_WALK_LEAVES_ONLY) == 0,
+          "split_walk failed");
+
+    // every pixel is covered by exactly one leaf
+    for(int y = 0; y < GRID; y++){
+        for(int x = 0; x < GRID; x++){
+            CHECK(wd.grid[y][x] == 1, "pixel %d,%d covered %d times",
+                  x, y, wd.grid[y][x]);
+        }
+    }
+
+    // the leaf thread matches the traversal
+    split_t *leaf = split_first_leaf(root);
+    CHECK(!leaf->prev_leaf, "first leaf has a prev_leaf");
+    for(size_t i = 0; i < wd.nleaves; i++, leaf = leaf->next_leaf){
+        CHECK(leaf == wd.leaves[i], "leaf %zu out of thread order", i);
+        CHECK(!leaf->next_leaf || leaf->next_leaf->prev_leaf == leaf,
+              "prev_leaf of leaf %zu", i);
+    }
+    CHECK(!leaf, "thread runs past the last leaf");
+    CHECK(split_last_leaf(root) == wd.leaves[wd.nleaves - 1], "last leaf");
+
+    // every window is in exactly one leaf, or hidden
+    size_t placed = 0;
+    for(size_t i = 0; i < wd.nleaves; i++){
+        if(wd.leaves[i]->win_info) placed++;
+    }
+    size_t framed = 0;
+    for(size_t i = 0; i < NWINS; i++){
+        if(infos[i].frame) framed++;
+    }
+    CHECK(placed == framed, "%zu windows in leaves, %zu with frames",
+          placed, framed);
+
+    // the focus is one of the leaves
+    CHECK(ws.focus && ws.focus->isleaf, "focus is not a leaf");
+    return 0;
+}
+
+///// Random operations
+
+static float frand(float lo, float hi){
+    return lo + (hi - lo) * (float)rand() / (float)RAND_MAX;
+}
+
+static ws_win_info_t *hidden_window(void){
+    for(size_t i = 0; i < NWINS; i++){
+        if(!infos[i].frame) return &infos[i];
+    }
+    return NULL;
+}
+
+static void hide(split_t *leaf){
+    if(!leaf->win_info) return;
+    leaf->win_info->frame = NULL;
+    leaf->win_info = NULL;
+}
+
+static void put(split_t *leaf, ws_win_info_t *info){
+    leaf->win_info = info;
+    if(info) info->frame = leaf;
+}
+
+static split_t *random_leaf(void){
+    return wd.leaves[(size_t)rand() % wd.nleaves];
+}
+
+static split_t *root_of(split_t *split){
+    while(split->parent) split = split->parent;
+    return split;
+}
+
+// returns the root, which might have changed
+static split_t *random_op(split_t *root){
+    split_t *leaf = random_leaf();
+    switch(rand() % 8){
+        case 0:
+        case 1: {
+            // split, and maybe fill the new frame
+            if(wd.nleaves >= MAX_LEAVES) break;
+            split_t *new = split_do_split(leaf, rand() % 2, frand(0.1, 0.9));
+            if(new && rand() % 2) put(new, hidden_window());
+        } break;
+        case 2: {
+            // remove
+            if(!leaf->parent) break;
+            hide(leaf);
+            bool had_focus = (ws.focus == leaf);
+            split_t *heir = split_do_remove(leaf);
+            if(had_focus) ws.focus = split_first_leaf(heir);
+        } break;
+        case 3:
+            // move, which must land on a leaf
+            leaf = do_split_move(leaf, rand() % 2, rand() % 2);
+            if(!leaf || !leaf->isleaf){
+                fprintf(stderr, "FAIL: do_split_move returned a non-leaf\n");
+                failures++;
+            }else{
+                ws.focus = leaf;
+            }
+            break;
+        case 4: {
+            // swap windows between two leaves
+            split_t *other = random_leaf();
+            ws_win_info_t *a = leaf->win_info;
+            ws_win_info_t *b = other->win_info;
+            put(leaf, b);
+            put(other, a);
+        } break;
+        case 5:
+            // resize
+            split_do_resize(leaf, rand() % 2, frand(-0.2, 0.2));
+            break;
+        case 6:
+            // only, now and then
+            if(rand() % 8) break;
+            for(size_t i = 0; i < wd.nleaves; i++){
+                if(wd.leaves[i] != leaf) hide(wd.leaves[i]);
+            }
+            // like workspace_only, the remaining frame takes the focus
+            root = split_do_only(leaf);
+            ws.focus = root;
+            break;
+        case 7: {
+            // grid, now and then
+            if(rand() % 4 || wd.nleaves >= MAX_LEAVES / 2) break;
+            split_t *last;
+            split_do_grid(leaf, 2 + (size_t)rand() % 12, &last);
+        } break;
+    }
+    return root_of(root);
+}
+
+static int run_random(unsigned seed, int nops){
+    srand(seed);
+    slab_t slab;
+    slab_init(&slab, &split_slab_type);
+    memset(infos, 0, sizeof(infos));
+    split_t *root = split_new(&slab, NULL);
+    if(!root){
+        perror("split_new");
+        exit(1);
+    }
+    ws.focus = root;
+    int ret = 0;
+    for(int i = 0; i < nops; i++){
+        if(check_tree(root)){
+            fprintf(stderr, "seed %u, op %d\n", seed, i);
+            ret = -1;
+            break;
+        }
+        root = random_op(root);
+    }
+    // split_free expects the windows to be gone already
+    for(size_t i = 0; i < NWINS; i++){
+        if(infos[i].frame) hide(infos[i].frame);
+    }
+    split_free(root);
+    if(split_slab_type.live){
+        fprintf(stderr, "FAIL: %zu splits leaked\n", split_slab_type.live);
+        failures++;
+        ret = -1;
+    }
+    slab_deinit(&slab);
+    return ret;
+}
+
+///// Benchmarks
+
+static double now(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// how long to run each measurement, in seconds
+#define BENCH_TIME 0.2
+
+// keeps the compiler from throwing away the work
+static volatile float sink;
+
+static split_walk_t count_cb(split_t *split, void *data,
+                             float t, float b, float l, float r){
+    (void)split;
+    *(float*)data += (b - t) * (r - l);
+    return SPLIT_WALK_CONTINUE;
+}
+
+static void bench_size(size_t n){
+    srand(1);
+    slab_t slab;
+    slab_init(&slab, &split_slab_type);
+    split_t *root = split_new(&slab, NULL);
+    if(!root){
+        perror("split_new");
+        exit(1);
+    }
+    ws.focus = root;
+
+    // grow a random tree of n leaves
+    split_t **leaves = malloc(sizeof(*leaves) * n);
+    if(!leaves){
+        perror("malloc");
+        exit(1);
+    }
+    leaves[0] = root;
+    size_t nleaves = 1;
+    while(nleaves < n){
+        size_t i = (size_t)rand() % nleaves;
+        split_t *new = split_do_split(leaves[i], rand() % 2, frand(0.3, 0.7));
+        if(!new){
+            perror("split_do_split");
+            exit(1);
+        }
+        // the old leaf may have become the parent of two new leaves
+        if(!leaves[i]->isleaf) leaves[i] = leaves[i]->frames[0];
+        leaves[nleaves++] = new;
+    }
+
+    // get_sides on every leaf, round and round
+    double start = now(), end;
+    size_t ops = 0;
+    float acc = 0;
+    do{
+        for(size_t i = 0; i < nleaves; i++){
+            sides_t s = get_sides(leaves[i]);
+            acc += s.b - s.t;
+        }
+        ops += nleaves;
+        end = now();
+    }while(end - start < BENCH_TIME);
+    double sides_rate = ops / (end - start);
+
+    // moves from random leaves in random directions
+    start = now();
+    ops = 0;
+    do{
+        for(size_t i = 0; i < 1000; i++){
+            split_t *leaf = leaves[(size_t)rand() % nleaves];
+            leaf = do_split_move(leaf, rand() % 2, rand() % 2);
+            acc += leaf->isleaf;
+        }
+        ops += 1000;
+        end = now();
+    }while(end - start < BENCH_TIME);
+    double move_rate = ops / (end - start);
+
+    // whole-tree traversals
+    start = now();
+    ops = 0;
+    do{
+        split_walk(root, count_cb, &acc, SPLIT_WALK_LEAVES_ONLY);
+        ops++;
+        end = now();
+    }while(end - start < BENCH_TIME);
+    double walk_rate = ops / (end - start);
+
+    sink = acc;
+    printf("%8zu %14.0f %14.0f %14.1f %14.0f\n", n, sides_rate, move_rate,
+           walk_rate, walk_rate * n);
+
+    free(leaves);
+    split_free(root);
+    slab_deinit(&slab);
+}
+
+int main(int argc, char **argv){
+    int nseeds = argc > 1 ? atoi(argv[1]) : 20;
+
+    printf("randomized tests: %d seeds of 5000 ops\n", nseeds);
+    for(int seed = 1; seed <= nseeds; seed++){
+        run_random((unsigned)seed, 5000);
+    }
+    free(wd.leaves);
+    if(failures){
+        printf("%d failures\n", failures);
+        return 1;
+    }
+    printf("all invariants held\n\n");
+
+    printf("%8s %14s %14s %14s %14s\n", "leaves", "get_sides/s",
+           "move/s", "walks/s", "leaves/s");
+    size_t sizes[] = {1, 10, 100, 1000, 10000};
+    for(size_t i = 0; i < sizeof(sizes) / sizeof(*sizes); i++){
+        bench_size(sizes[i]);
+    }
+    return 0;
+}
@@ -9,6 +9,7 @@
 #include "workspace.h"
 #include "split.h"
 #include "backend.h"
+#include "launch.h"
 
 static void exec(const char *shcmd){
     logmsg("called exec\n");
@@ -23,8 +24,8 @@ static void exec(const char *shcmd){
         perror("execl");
         exit(127);
     }
-    // parent continues with whatever it was doing
-    return;
+    // parent continues with whatever it was doing, its window opens here
+    launch_remember(pid);
 }
 
 #define DEFINE_KEY_HANDLER(func_name) \
@@ -55,22 +56,32 @@ DEFINE_KEY_HANDLER(dovsplit)
 FINISH_KEY_HANDLER
 
 DEFINE_KEY_HANDLER(goleft)
-    split_t *new = split_move_left(g_workspace->focus);
+    split_t *new = workspace_neighbor_left(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
 FINISH_KEY_HANDLER
 
 DEFINE_KEY_HANDLER(goright)
-    split_t *new = split_move_right(g_workspace->focus);
+    split_t *new = workspace_neighbor_right(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
 FINISH_KEY_HANDLER
 
 DEFINE_KEY_HANDLER(goup)
-    split_t *new = split_move_up(g_workspace->focus);
+    split_t *new = workspace_neighbor_up(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
 FINISH_KEY_HANDLER
 
 DEFINE_KEY_HANDLER(godown)
-    split_t *new = split_move_down(g_workspace->focus);
+    split_t *new = workspace_neighbor_down(g_workspace, g_workspace->focus);
+    workspace_focus_frame(g_workspace, new);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(gonext)
+    split_t *new = workspace_next_frame(g_workspace, g_workspace->focus);
+    workspace_focus_frame(g_workspace, new);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(goprev)
+    split_t *new = workspace_prev_frame(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
 FINISH_KEY_HANDLER
 
@@ -78,23 +89,59 @@ DEFINE_KEY_HANDLER(remove_frame)
     workspace_remove_frame(g_workspace, g_workspace->focus);
 FINISH_KEY_HANDLER
 
+DEFINE_KEY_HANDLER(only)
+    workspace_only(g_workspace, g_workspace->focus);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(tile_hidden)
+    workspace_tile_hidden(g_workspace, g_workspace->focus);
+FINISH_KEY_HANDLER
+
+/* how much one resize keypress moves a border, as a fraction of its split.
+   The keys move the border in their direction, like the focus keys. */
+#define RESIZE_STEP 0.02f
+
+DEFINE_KEY_HANDLER(border_left)
+    workspace_resize(g_workspace, g_workspace->focus, false, -RESIZE_STEP);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(border_right)
+    workspace_resize(g_workspace, g_workspace->focus, false, RESIZE_STEP);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(border_up)
+    workspace_resize(g_workspace, g_workspace->focus, true, -RESIZE_STEP);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(border_down)
+    workspace_resize(g_workspace, g_workspace->focus, true, RESIZE_STEP);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(undo)
+    workspace_undo(g_workspace);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(redo)
+    workspace_redo(g_workspace);
+FINISH_KEY_HANDLER
+
 DEFINE_KEY_HANDLER(swapleft)
-    split_t *new = split_move_left(g_workspace->focus);
+    split_t *new = workspace_neighbor_left(g_workspace, g_workspace->focus);
     workspace_swap_windows_from_frames(g_workspace->focus, new);
 FINISH_KEY_HANDLER
 
 DEFINE_KEY_HANDLER(swapright)
-    split_t *new = split_move_right(g_workspace->focus);
+    split_t *new = workspace_neighbor_right(g_workspace, g_workspace->focus);
     workspace_swap_windows_from_frames(g_workspace->focus, new);
 FINISH_KEY_HANDLER
 
 DEFINE_KEY_HANDLER(swapup)
-    split_t *new = split_move_up(g_workspace->focus);
+    split_t *new = workspace_neighbor_up(g_workspace, g_workspace->focus);
     workspace_swap_windows_from_frames(g_workspace->focus, new);
 FINISH_KEY_HANDLER
 
 DEFINE_KEY_HANDLER(swapdown)
-    split_t *new = split_move_down(g_workspace->focus);
+    split_t *new = workspace_neighbor_down(g_workspace, g_workspace->focus);
     workspace_swap_windows_from_frames(g_workspace->focus, new);
 FINISH_KEY_HANDLER
 
@@ -106,6 +153,20 @@ DEFINE_KEY_HANDLER(prev_win)
     workspace_prev_hidden_win_at(g_workspace, g_workspace->focus);
 FINISH_KEY_HANDLER
 
+DEFINE_KEY_HANDLER(last_win)
+    workspace_last_window(g_workspace);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(same_app_win)
+    // cycle through the windows of the same application as the focused one
+    split_t *frame = g_workspace->focus;
+    if(frame->win_info){
+        be_window_t *be_window = frame->win_info->window->be_window;
+        workspace_bring_window(g_workspace, frame, WINDEX_APP_ID,
+                               be_window_get_app_id(be_window));
+    }
+FINISH_KEY_HANDLER
+
 DEFINE_KEY_HANDLER(close_window)
     if(g_workspace->focus->win_info){
         be_window_close(g_workspace->focus->win_info->window->be_window);
@@ -113,16 +174,81 @@ DEFINE_KEY_HANDLER(close_window)
 FINISH_KEY_HANDLER
 
 
+// a border being dragged with the pointer
+static border_t drag;
+static bool dragging = false;
+
+// click-to-focus, or click-and-drag a border
+void handle_pointer_press(int32_t x, int32_t y){
+    if(workspace_border_at(g_workspace, x, y, &drag)){
+        // the whole drag can be undone at once
+        workspace_checkpoint(g_workspace);
+        dragging = true;
+        return;
+    }
+    split_t *frame = workspace_frame_at(g_workspace, x, y);
+    if(!frame || frame == g_workspace->focus) return;
+    workspace_focus_frame(g_workspace, frame);
+    be_repaint(g_workspace->be);
+}
+
+void handle_pointer_release(int32_t x, int32_t y){
+    (void)x; (void)y;
+    dragging = false;
+}
+
+void handle_pointer_motion(int32_t x, int32_t y){
+    if(!dragging) return;
+    // stop if the border disappeared out from under us
+    dragging = workspace_drag_border(g_workspace, &drag, x, y);
+    be_repaint(g_workspace->be);
+}
+
+
+DEFINE_KEY_HANDLER(goto_workspace)
+    // data is the name of the workspace
+    workspace_t *ws = workspace_get(data);
+    if(ws) workspace_switch(ws);
+FINISH_KEY_HANDLER
+
+DEFINE_KEY_HANDLER(move_to_workspace)
+    // data is the name of the workspace
+    split_t *focus = g_workspace->focus;
+    workspace_t *ws = focus->win_info ? workspace_get(data) : NULL;
+    if(ws) workspace_move_window(g_workspace, ws, focus->win_info->window);
+FINISH_KEY_HANDLER
+
 #define ADD_KEY(xkey, func) \
     if(be_handle_key(be, MOD_CTRL, \
                      XKB_KEY_ ## xkey, \
-                     &func, be)){ \
+                     &func, be, false)){ \
         goto fail; \
     }
 #define ADD_KEY_SHIFT(xkey, func) \
     if(be_handle_key(be, MOD_CTRL | MOD_SHIFT, \
                      XKB_KEY_ ## xkey, \
-                     &func, be)){ \
+                     &func, be, false)){ \
+        goto fail; \
+    }
+// ctrl-N shows workspace "N"
+#define ADD_WORKSPACE_KEY(n) \
+    if(be_handle_key(be, MOD_CTRL, \
+                     XKB_KEY_ ## n, \
+                     &goto_workspace, #n, false)){ \
+        goto fail; \
+    }
+// ctrl-shift-N sends the focused window to workspace "N"
+#define ADD_MOVE_WORKSPACE_KEY(n) \
+    if(be_handle_key(be, MOD_CTRL | MOD_SHIFT, \
+                     XKB_KEY_ ## n, \
+                     &move_to_workspace, #n, false)){ \
+        goto fail; \
+    }
+// these keep going while the key is held
+#define ADD_KEY_ALT_REPEAT(xkey, func) \
+    if(be_handle_key(be, MOD_CTRL | MOD_ALT, \
+                     XKB_KEY_ ## xkey, \
+                     &func, be, true)){ \
         goto fail; \
     }
 
@@ -135,14 +261,44 @@ int add_bindings(backend_t *be){
     ADD_KEY(j, godown);
     ADD_KEY(k, goup);
     ADD_KEY(l, goright);
+    ADD_KEY(Tab, gonext);
+    ADD_KEY_SHIFT(Tab, goprev);
     ADD_KEY(y, remove_frame);
+    ADD_KEY(o, only);
+    ADD_KEY(t, tile_hidden);
+    ADD_KEY(u, undo);
+    ADD_KEY_SHIFT(u, redo);
     ADD_KEY(i, close_window);
     ADD_KEY_SHIFT(h, swapleft);
     ADD_KEY_SHIFT(j, swapdown);
     ADD_KEY_SHIFT(k, swapup);
     ADD_KEY_SHIFT(l, swapright);
+    ADD_KEY_ALT_REPEAT(h, border_left);
+    ADD_KEY_ALT_REPEAT(j, border_down);
+    ADD_KEY_ALT_REPEAT(k, border_up);
+    ADD_KEY_ALT_REPEAT(l, border_right);
     ADD_KEY(space, next_win);
     ADD_KEY_SHIFT(space, prev_win);
+    ADD_KEY(grave, last_win);
+    ADD_KEY(n, same_app_win);
+    ADD_WORKSPACE_KEY(1);
+    ADD_WORKSPACE_KEY(2);
+    ADD_WORKSPACE_KEY(3);
+    ADD_WORKSPACE_KEY(4);
+    ADD_WORKSPACE_KEY(5);
+    ADD_WORKSPACE_KEY(6);
+    ADD_WORKSPACE_KEY(7);
+    ADD_WORKSPACE_KEY(8);
+    ADD_WORKSPACE_KEY(9);
+    ADD_MOVE_WORKSPACE_KEY(1);
+    ADD_MOVE_WORKSPACE_KEY(2);
+    ADD_MOVE_WORKSPACE_KEY(3);
+    ADD_MOVE_WORKSPACE_KEY(4);
+    ADD_MOVE_WORKSPACE_KEY(5);
+    ADD_MOVE_WORKSPACE_KEY(6);
+    ADD_MOVE_WORKSPACE_KEY(7);
+    ADD_MOVE_WORKSPACE_KEY(8);
+    ADD_MOVE_WORKSPACE_KEY(9);
     return 0;
 
 fail:
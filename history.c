@@ -0,0 +1,160 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "history.h"
+
+// how many layouts each of the undo and redo stacks can hold
+#define HISTORY_MAX 256
+
+typedef struct {
+    layout_t *layouts[HISTORY_MAX];
+    size_t n;
+} layout_stack_t;
+
+struct history_t {
+    layout_stack_t undo;
+    layout_stack_t redo;
+};
+
+layout_t *layout_capture(workspace_t *ws){
+    layout_t *layout = malloc(sizeof(*layout));
+    if(!layout) return NULL;
+    layout->nroots = 0;
+    layout->focus = 0;
+    layout->roots = malloc(sizeof(*layout->roots) * (ws->nroots + 1));
+    if(!layout->roots) goto cu_layout;
+    layout->screens = malloc(sizeof(*layout->screens) * (ws->nroots + 1));
+    if(!layout->screens) goto cu_roots;
+    for(size_t i = 0; i < ws->nroots; i++){
+        char *screen = strdup(ws->roots[i]->screen_id);
+        if(!screen) goto cu_screens;
+        snap_t *snap = split_snapshot(ws->roots[i]);
+        if(!snap){
+            free(screen);
+            goto cu_screens;
+        }
+        layout->screens[layout->nroots] = screen;
+        layout->roots[layout->nroots++] = snap;
+    }
+    // find the focus
+    if(ws->nroots){
+        split_t *leaf = split_first_leaf(ws->roots[0]);
+        for(; leaf && leaf != ws->focus; leaf = leaf->next_leaf){
+            layout->focus++;
+        }
+        if(!leaf) layout->focus = 0;
+    }
+    return layout;
+
+cu_screens:
+    for(size_t i = 0; i < layout->nroots; i++){
+        snap_unref(layout->roots[i]);
+        free(layout->screens[i]);
+    }
+    free(layout->screens);
+cu_roots:
+    free(layout->roots);
+cu_layout:
+    free(layout);
+    return NULL;
+}
+
+void layout_free(layout_t *layout){
+    if(!layout) return;
+    for(size_t i = 0; i < layout->nroots; i++){
+        snap_unref(layout->roots[i]);
+        free(layout->screens[i]);
+    }
+    free(layout->roots);
+    free(layout->screens);
+    free(layout);
+}
+
+bool layout_equal(layout_t *a, layout_t *b){
+    if(a->nroots != b->nroots || a->focus != b->focus) return false;
+    for(size_t i = 0; i < a->nroots; i++){
+        if(strcmp(a->screens[i], b->screens[i]) != 0) return false;
+        if(!snap_equal(a->roots[i], b->roots[i])) return false;
+    }
+    return true;
+}
+
+static size_t snap_leaves(snap_t *snap){
+    if(snap->isleaf) return 1;
+    size_t n = 0;
+    for(size_t i = 0; i < snap->nframes; i++){
+        n += snap_leaves(snap->frames[i]);
+    }
+    return n;
+}
+
+snap_t *layout_find_root(layout_t *layout, const char *screen, size_t *focus){
+    *focus = SIZE_MAX;
+    // the focus counts leaves across all of the roots before this one
+    size_t first = 0;
+    for(size_t i = 0; i < layout->nroots; i++){
+        size_t n = snap_leaves(layout->roots[i]);
+        if(strcmp(layout->screens[i], screen) == 0){
+            if(layout->focus >= first && layout->focus < first + n){
+                *focus = layout->focus - first;
+            }
+            return layout->roots[i];
+        }
+        first += n;
+    }
+    return NULL;
+}
+
+static void stack_push(layout_stack_t *s, layout_t *layout){
+    if(s->n == HISTORY_MAX){
+        // forget the oldest layout
+        layout_free(s->layouts[0]);
+        memmove(&s->layouts[0], &s->layouts[1],
+                sizeof(*s->layouts) * (HISTORY_MAX - 1));
+        s->n--;
+    }
+    s->layouts[s->n++] = layout;
+}
+
+static void stack_clear(layout_stack_t *s){
+    while(s->n) layout_free(s->layouts[--s->n]);
+}
+
+history_t *history_new(void){
+    history_t *h = malloc(sizeof(*h));
+    if(!h) return NULL;
+    h->undo.n = 0;
+    h->redo.n = 0;
+    return h;
+}
+
+void history_free(history_t *h){
+    if(!h) return;
+    stack_clear(&h->undo);
+    stack_clear(&h->redo);
+    free(h);
+}
+
+void history_push(history_t *h, layout_t *layout){
+    // a change that didn't change anything doesn't need to be undone
+    if(h->undo.n && layout_equal(h->undo.layouts[h->undo.n - 1], layout)){
+        layout_free(layout);
+        return;
+    }
+    stack_push(&h->undo, layout);
+    stack_clear(&h->redo);
+}
+
+layout_t *history_undo(history_t *h, layout_t *current){
+    if(!h->undo.n) return NULL;
+    stack_push(&h->redo, current);
+    return h->undo.layouts[--h->undo.n];
+}
+
+layout_t *history_redo(history_t *h, layout_t *current){
+    if(!h->redo.n) return NULL;
+    stack_push(&h->undo, current);
+    return h->redo.layouts[--h->redo.n];
+}
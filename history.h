@@ -0,0 +1,46 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "venowm.h"
+#include "split.h"
+
+/* The layout of a whole workspace at one point in time: a snapshot of each
+   root, plus which frame had focus.  Snapshots share every unchanged subtree
+   with each other (see snap_t), so keeping lots of layouts around is cheap. */
+typedef struct {
+    snap_t **roots;
+    // the screen_id of each root, since screens come and go
+    char **screens;
+    size_t nroots;
+    // which leaf had focus, counting leaves in screen order
+    size_t focus;
+} layout_t;
+
+// returns NULL for error
+layout_t *layout_capture(workspace_t *ws);
+void layout_free(layout_t *layout);
+bool layout_equal(layout_t *a, layout_t *b);
+/* the snapshot of the root that was on a screen, or NULL if that screen
+   wasn't around.  *focus is set to which of its leaves had focus, or
+   SIZE_MAX. */
+snap_t *layout_find_root(layout_t *layout, const char *screen, size_t *focus);
+
+/* A history_t is a bounded pair of undo and redo stacks of layouts.  The
+   oldest layouts are forgotten once the stacks fill up. */
+typedef struct history_t history_t;
+
+history_t *history_new(void);
+void history_free(history_t *h);
+
+/* record the layout from before a change, and forget the redo stack.  The
+   history owns the layout afterwards. */
+void history_push(history_t *h, layout_t *layout);
+
+/* Trade the current layout for the previous (or next) one.  Returns NULL if
+   there is nothing to undo (or redo), in which case *current is not taken.
+   Otherwise the history owns *current, and the caller owns the return value.
+   */
+layout_t *history_undo(history_t *h, layout_t *current);
+layout_t *history_redo(history_t *h, layout_t *current);
+
+#endif // HISTORY_H
@@ -0,0 +1,117 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "launch.h"
+#include "workspace.h"
+
+// how long a launch waits for its window
+#define LAUNCH_TIMEOUT_MS 60000
+// how many parents of a client are checked
+#define MAX_DEPTH 4
+
+typedef struct {
+    char *workspace;
+    // split_t.id of the frame
+    uint64_t frame;
+    uint64_t when;
+} launch_t;
+
+KHASH_MAP_INIT_INT(launch, launch_t)
+
+static khash_t(launch) *launches = NULL;
+
+static uint64_t now_ms(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void forget(khiter_t k){
+    free(kh_value(launches, k).workspace);
+    kh_del(launch, launches, k);
+}
+
+// drop launches which never got a window
+static void expire(uint64_t now){
+    for(khiter_t k = kh_begin(launches); k != kh_end(launches); k++){
+        if(!kh_exist(launches, k)) continue;
+        if(now - kh_value(launches, k).when > LAUNCH_TIMEOUT_MS) forget(k);
+    }
+}
+
+void launch_remember(pid_t pid){
+    if(!launches){
+        launches = kh_init(launch);
+        if(!launches) return;
+    }
+    uint64_t now = now_ms();
+    expire(now);
+
+    split_t *focus = g_workspace->focus;
+    char *name = strdup(g_workspace->name);
+    if(!name) return;
+    int ret;
+    khiter_t k = kh_put(launch, launches, pid, &ret);
+    if(ret < 0){
+        free(name);
+        return;
+    }
+    // a pid which was used before
+    if(!ret) free(kh_value(launches, k).workspace);
+    kh_value(launches, k) = (launch_t){
+        .workspace = name,
+        .frame = focus ? focus->id : 0,
+        .when = now,
+    };
+}
+
+// the parent of a process, or 0 if it can't be read
+static pid_t parent_of(pid_t pid){
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+    FILE *f = fopen(path, "r");
+    if(!f) return 0;
+    char buf[512];
+    size_t len = fread(buf, 1, sizeof(buf) - 1, f);
+    fclose(f);
+    buf[len] = '\0';
+    // "pid (comm) state ppid ...", where comm may have anything in it
+    char *p = strrchr(buf, ')');
+    int ppid;
+    if(!p || sscanf(p + 1, " %*c %d", &ppid) != 1) return 0;
+    return (pid_t)ppid;
+}
+
+bool launch_claim(pid_t pid, workspace_t **ws, split_t **frame){
+    if(!launches || !kh_size(launches)) return false;
+    khiter_t k = kh_end(launches);
+    // stop at init, or at venowm itself, which launched everything
+    pid_t self = getpid();
+    for(int i = 0; i < MAX_DEPTH && pid > 1 && pid != self; i++){
+        k = kh_get(launch, launches, pid);
+        if(k != kh_end(launches)) break;
+        pid = parent_of(pid);
+    }
+    if(k == kh_end(launches)) return false;
+
+    launch_t launch = kh_value(launches, k);
+    bool fresh = now_ms() - launch.when <= LAUNCH_TIMEOUT_MS;
+    *ws = fresh ? workspace_find(launch.workspace) : NULL;
+    *frame = *ws ? workspace_frame_by_id(*ws, launch.frame) : NULL;
+    // one launch, one window
+    forget(k);
+    return *ws != NULL;
+}
+
+void launch_free(void){
+    if(!launches) return;
+    for(khiter_t k = kh_begin(launches); k != kh_end(launches); k++){
+        if(kh_exist(launches, k)) free(kh_value(launches, k).workspace);
+    }
+    kh_destroy(launch, launches);
+    launches = NULL;
+}
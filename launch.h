@@ -0,0 +1,27 @@
+#ifndef LAUNCH_H
+#define LAUNCH_H
+
+#include <sys/types.h>
+
+#include "venowm.h"
+
+/* Launched programs remember the frame they were launched from, so their
+   window opens there, even if the focus has moved on by the time it maps.
+
+   The compositor can't tell which launch a window came from, except by the
+   pid of the client that owns it.  Programs are often started through a
+   shell or a wrapper script, so the client's parents are checked too.  A
+   launch is only good for one window, and it is forgotten after a while if
+   no window shows up. */
+
+// remember that pid was launched from the focused frame of g_workspace
+void launch_remember(pid_t pid);
+
+/* Find the launch which a client with this pid came from, and forget it.
+   *frame is NULL if the frame is gone, but the workspace is still there.
+   Returns false if there was no such launch, or its workspace is gone. */
+bool launch_claim(pid_t pid, workspace_t **ws, split_t **frame);
+
+void launch_free(void);
+
+#endif // LAUNCH_H
@@ -0,0 +1,359 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+
+#include "layoutfile.h"
+#include "workspace.h"
+
+// how long the layout has to stay still before it gets written
+#define SAVE_DELAY_MS 2000
+
+// sanity limits for reading the file
+#define MAX_DEPTH 64
+#define MAX_FRAMES 4096
+
+#define SEPS " \t\n"
+
+static be_timer_t *timer = NULL;
+static bool pending = false;
+
+// saved roots of workspaces which haven't been made yet
+typedef struct unclaimed_t {
+    char *name;
+    saved_root_t *roots;
+    struct unclaimed_t *next;
+} unclaimed_t;
+
+static unclaimed_t *unclaimed = NULL;
+
+void saved_root_free(saved_root_t *saved){
+    while(saved){
+        saved_root_t *next = saved->next;
+        free(saved->screen);
+        snap_unref(saved->snap);
+        free(saved);
+        saved = next;
+    }
+}
+
+// which leaf of a root has the workspace's focus, or SIZE_MAX
+static size_t root_focus(workspace_t *ws, split_t *root){
+    split_t *end = split_last_leaf(root)->next_leaf;
+    split_t *leaf = split_first_leaf(root);
+    for(size_t i = 0; leaf != end; leaf = leaf->next_leaf, i++){
+        if(leaf == ws->focus) return i;
+    }
+    return SIZE_MAX;
+}
+
+saved_root_t *saved_root_new(workspace_t *ws, split_t *root){
+    saved_root_t *saved = malloc(sizeof(*saved));
+    if(!saved) return NULL;
+    *saved = (saved_root_t){.focus = root_focus(ws, root)};
+    saved->screen = strdup(root->screen_id);
+    if(!saved->screen) goto fail;
+    saved->snap = split_snapshot(root);
+    if(!saved->snap) goto fail;
+    return saved;
+
+fail:
+    saved_root_free(saved);
+    return NULL;
+}
+
+// returns NULL if there is nowhere to keep the file
+static const char *get_path(char *buf, size_t size){
+    const char *home = getenv("HOME");
+    if(!home) return NULL;
+    int len = snprintf(buf, size, "%s/.venowm-layout", home);
+    if(len < 0 || (size_t)len >= size) return NULL;
+    return buf;
+}
+
+///// Writing
+
+static void write_snap(FILE *f, snap_t *snap){
+    if(snap->isleaf){
+        fprintf(f, " L");
+        return;
+    }
+    fprintf(f, " %c%zu", snap->isvertical ? 'V' : 'H', snap->nframes);
+    for(size_t i = 1; i < snap->nframes; i++){
+        fprintf(f, " %g", snap->bounds[i]);
+    }
+    for(size_t i = 0; i < snap->nframes; i++){
+        write_snap(f, snap->frames[i]);
+    }
+}
+
+static void write_root(FILE *f, const char *screen, size_t focus,
+                       snap_t *snap){
+    fprintf(f, "root %s ", screen);
+    if(focus == SIZE_MAX){
+        fprintf(f, "-");
+    }else{
+        fprintf(f, "%zu", focus);
+    }
+    write_snap(f, snap);
+    fprintf(f, "\n");
+}
+
+static void write_saved(FILE *f, saved_root_t *saved){
+    for(; saved; saved = saved->next){
+        write_root(f, saved->screen, saved->focus, saved->snap);
+    }
+}
+
+static int write_workspace(FILE *f, workspace_t *ws){
+    fprintf(f, "workspace %s\n", ws->name);
+    for(size_t i = 0; i < ws->nroots; i++){
+        // this is cheap, the snapshot is usually cached already
+        snap_t *snap = split_snapshot(ws->roots[i]);
+        if(!snap) return -1;
+        write_root(f, ws->roots[i]->screen_id, root_focus(ws, ws->roots[i]),
+                   snap);
+        snap_unref(snap);
+    }
+    // keep the parked roots, and the ones we haven't seen this time
+    write_saved(f, ws->saved);
+    return 0;
+}
+
+int layoutfile_save(void){
+    pending = false;
+    /* with no screens left the roots have already been torn down, and writing
+       now would throw away the file we have */
+    if(!g_nscreens) return 0;
+
+    char path[PATH_MAX];
+    char tmp[PATH_MAX];
+    if(!get_path(path, sizeof(path))) return -1;
+    int len = snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if(len < 0 || (size_t)len >= sizeof(tmp)) return -1;
+
+    // write to the side and rename, so a crash never leaves half a file
+    FILE *f = fopen(tmp, "w");
+    if(!f){
+        logmsg("unable to open %s\n", tmp);
+        return -1;
+    }
+    fprintf(f, "# venowm layout\n");
+    for(size_t i = 0; i < g_nworkspaces; i++){
+        if(write_workspace(f, g_workspaces[i])) goto fail;
+    }
+    // and the workspaces which haven't been used this time
+    for(unclaimed_t *u = unclaimed; u; u = u->next){
+        fprintf(f, "workspace %s\n", u->name);
+        write_saved(f, u->roots);
+    }
+    if(ferror(f)) goto fail;
+    if(fclose(f)){
+        f = NULL;
+        goto fail;
+    }
+    if(rename(tmp, path)){
+        logmsg("unable to rename %s\n", tmp);
+        remove(tmp);
+        return -1;
+    }
+    return 0;
+
+fail:
+    logmsg("unable to write %s\n", tmp);
+    if(f) fclose(f);
+    remove(tmp);
+    return -1;
+}
+
+static void handle_save_timer(void *data){
+    (void)data;
+    layoutfile_save();
+}
+
+void layoutfile_changed(void){
+    if(!timer) return;
+    pending = true;
+    be_timer_arm(timer, SAVE_DELAY_MS);
+}
+
+int layoutfile_init(backend_t *be){
+    timer = be_timer_new(be, handle_save_timer, NULL);
+    return timer ? 0 : -1;
+}
+
+void layoutfile_free(void){
+    if(pending) layoutfile_save();
+    be_timer_free(timer);
+    timer = NULL;
+    while(unclaimed){
+        unclaimed_t *next = unclaimed->next;
+        free(unclaimed->name);
+        saved_root_free(unclaimed->roots);
+        free(unclaimed);
+        unclaimed = next;
+    }
+}
+
+saved_root_t *layoutfile_claim(const char *name){
+    for(unclaimed_t **u = &unclaimed; *u; u = &(*u)->next){
+        if(strcmp((*u)->name, name) != 0) continue;
+        unclaimed_t *found = *u;
+        *u = found->next;
+        saved_root_t *roots = found->roots;
+        free(found->name);
+        free(found);
+        return roots;
+    }
+    return NULL;
+}
+
+///// Reading
+
+// where the saved roots of a workspace go, NULL for no memory
+static saved_root_t **saved_list(const char *name){
+    workspace_t *ws = workspace_find(name);
+    if(ws) return &ws->saved;
+    unclaimed_t *u = unclaimed;
+    for(; u; u = u->next){
+        if(strcmp(u->name, name) == 0) return &u->roots;
+    }
+    u = malloc(sizeof(*u));
+    if(!u) return NULL;
+    u->name = strdup(name);
+    if(!u->name){
+        free(u);
+        return NULL;
+    }
+    u->roots = NULL;
+    u->next = unclaimed;
+    unclaimed = u;
+    return &u->roots;
+}
+
+static snap_t *read_snap(char **save, int depth){
+    char *tok = strtok_r(NULL, SEPS, save);
+    if(!tok || depth > MAX_DEPTH) return NULL;
+    if(strcmp(tok, "L") == 0){
+        snap_t *snap = snap_new(0);
+        if(!snap) return NULL;
+        snap->isleaf = true;
+        snap->isvertical = false;
+        snap->window = 0;
+        return snap;
+    }
+    if(tok[0] != 'H' && tok[0] != 'V') return NULL;
+    char *end;
+    unsigned long n = strtoul(tok + 1, &end, 10);
+    if(*end || n < 2 || n > MAX_FRAMES) return NULL;
+
+    snap_t *snap = snap_new(n);
+    if(!snap) return NULL;
+    snap->isleaf = false;
+    snap->isvertical = (tok[0] == 'V');
+    snap->window = 0;
+    snap->bounds[0] = 0.0;
+    snap->bounds[n] = 1.0;
+    for(size_t i = 1; i < n; i++){
+        tok = strtok_r(NULL, SEPS, save);
+        if(!tok) goto fail;
+        float bound = strtof(tok, &end);
+        if(*end || !(bound > snap->bounds[i - 1]) || !(bound < 1.0)){
+            goto fail;
+        }
+        snap->bounds[i] = bound;
+    }
+    for(size_t i = 0; i < n; i++){
+        snap_t *kid = read_snap(save, depth + 1);
+        if(!kid) goto fail;
+        snap->frames[snap->nframes++] = kid;
+        // a split never has a child with its own orientation
+        if(!kid->isleaf && kid->isvertical == snap->isvertical) goto fail;
+    }
+    return snap;
+
+fail:
+    snap_unref(snap);
+    return NULL;
+}
+
+// parse the rest of a "root" line, returns NULL for a bad line
+static saved_root_t *read_root(char **save){
+    char *screen = strtok_r(NULL, SEPS, save);
+    char *focus = strtok_r(NULL, SEPS, save);
+    if(!screen || !focus) return NULL;
+
+    saved_root_t *saved = malloc(sizeof(*saved));
+    if(!saved) return NULL;
+    *saved = (saved_root_t){.focus = SIZE_MAX};
+
+    if(strcmp(focus, "-") != 0){
+        char *end;
+        unsigned long long val = strtoull(focus, &end, 10);
+        if(*end || val >= SIZE_MAX) goto fail;
+        saved->focus = (size_t)val;
+    }
+    saved->screen = strdup(screen);
+    if(!saved->screen) goto fail;
+    saved->snap = read_snap(save, 0);
+    if(!saved->snap) goto fail;
+    // nothing may follow the tree
+    if(strtok_r(NULL, SEPS, save)) goto fail;
+    return saved;
+
+fail:
+    saved_root_free(saved);
+    return NULL;
+}
+
+int layoutfile_load(void){
+    char path[PATH_MAX];
+    if(!get_path(path, sizeof(path))) return 0;
+    FILE *f = fopen(path, "r");
+    // no file yet, nothing to do
+    if(!f) return 0;
+
+    int retval = 0;
+    char *line = NULL;
+    size_t size = 0;
+    size_t lineno = 0;
+    // where the next saved root goes, keeping the file's order
+    saved_root_t **tail = NULL;
+    while(getline(&line, &size, f) >= 0){
+        lineno++;
+        char *save;
+        char *tok = strtok_r(line, SEPS, &save);
+        if(!tok || tok[0] == '#') continue;
+        if(strcmp(tok, "workspace") == 0){
+            tok = strtok_r(NULL, SEPS, &save);
+            tail = tok ? saved_list(tok) : NULL;
+            if(!tail){
+                logmsg("%s:%zu: bad workspace\n", path, lineno);
+                continue;
+            }
+            while(*tail) tail = &(*tail)->next;
+            continue;
+        }
+        if(strcmp(tok, "root") == 0){
+            if(!tail) continue;
+            saved_root_t *saved = read_root(&save);
+            if(!saved){
+                logmsg("%s:%zu: bad root\n", path, lineno);
+                continue;
+            }
+            *tail = saved;
+            tail = &saved->next;
+            continue;
+        }
+        logmsg("%s:%zu: unknown line\n", path, lineno);
+    }
+    if(ferror(f)){
+        logmsg("unable to read %s\n", path);
+        retval = -1;
+    }
+    free(line);
+    fclose(f);
+    return retval;
+}
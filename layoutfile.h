@@ -0,0 +1,64 @@
+#ifndef LAYOUTFILE_H
+#define LAYOUTFILE_H
+
+#include "venowm.h"
+#include "split.h"
+
+/* The layout file keeps the split trees and focus of every workspace across
+   restarts, in ~/.venowm-layout.  Each root is saved under the identity of
+   its screen (see be_screen_get_id()), so a tree comes back on the same
+   monitor even if the monitors show up in a different order.
+
+   The file is plain text:
+
+       workspace <name>
+       root <screen-id> <focus> <tree>
+       root ...
+
+   where <focus> is which leaf of the tree had focus (counting in screen
+   order), or "-".  A tree is "L" for a leaf, or "H<n>" or "V<n>" followed by
+   the n-1 bounds between its frames and then its n subtrees.  So a screen
+   cut in half, with the right half cut into thirds, is:
+
+       H2 0.5 L V3 0.333 0.667 L L L
+
+   Windows are not saved, since they don't outlive venowm anyway.
+
+   The same list of saved roots is where a workspace parks the tree of a
+   screen that was unplugged, until that screen comes back. */
+
+// a root read from the file, waiting for its screen to show up
+typedef struct saved_root_t {
+    char *screen;
+    snap_t *snap;
+    // which leaf had focus, or SIZE_MAX
+    size_t focus;
+    struct saved_root_t *next;
+} saved_root_t;
+
+/* Save a live root under its screen_id, such as when its screen goes away.
+   The snapshot keeps the windows too, so they can be put back in their
+   frames if the screen comes back.  Returns NULL for error. */
+saved_root_t *saved_root_new(workspace_t *ws, split_t *root);
+// frees a whole list of saved roots
+void saved_root_free(saved_root_t *saved);
+
+// returns 0, or -1 if the debounce timer couldn't be made
+int layoutfile_init(backend_t *be);
+// writes the file if a write was still waiting
+void layoutfile_free(void);
+
+/* Read the file into each workspace's list of saved roots.  This has to
+   happen before any screens show up, so workspace_restore() can build each
+   root in one pass before the first frame is drawn.  Roots of workspaces
+   which don't exist yet wait for layoutfile_claim().  A missing file is not
+   an error.  Returns 0 or -1. */
+int layoutfile_load(void);
+// take the saved roots of a new workspace, or NULL if it had none
+saved_root_t *layoutfile_claim(const char *name);
+// write the file right away, returns 0 or -1
+int layoutfile_save(void);
+// the layout changed, so write the file once things settle down
+void layoutfile_changed(void);
+
+#endif // LAYOUTFILE_H
@@ -0,0 +1,338 @@
+#include <stdlib.h>
+
+#include "leafindex.h"
+
+// fanout of R-tree nodes
+#define NODE_MAX 8
+#define NODE_MIN 3
+
+typedef struct leafidx_node_t {
+    struct leafidx_node_t *parent;
+    bool isleaf;
+    int n;
+    // kids are split_t's in a leaf node, or more leafidx_node_t's otherwise
+    rect_t rects[NODE_MAX];
+    void *kids[NODE_MAX];
+} lnode_t;
+
+struct leafindex_t {
+    lnode_t *root;
+};
+
+static rect_t rect_union(rect_t a, rect_t b){
+    return (rect_t){
+        .t = a.t < b.t ? a.t : b.t,
+        .b = a.b > b.b ? a.b : b.b,
+        .l = a.l < b.l ? a.l : b.l,
+        .r = a.r > b.r ? a.r : b.r,
+    };
+}
+
+static int64_t rect_area(rect_t a){
+    return (int64_t)(a.r - a.l) * (int64_t)(a.b - a.t);
+}
+
+static lnode_t *node_new(bool isleaf){
+    lnode_t *node = malloc(sizeof(*node));
+    if(!node) return NULL;
+    node->parent = NULL;
+    node->isleaf = isleaf;
+    node->n = 0;
+    return node;
+}
+
+static rect_t node_bbox(lnode_t *node){
+    if(node->n == 0) return (rect_t){0};
+    rect_t out = node->rects[0];
+    for(int i = 1; i < node->n; i++){
+        out = rect_union(out, node->rects[i]);
+    }
+    return out;
+}
+
+// write an entry into a node, and fix the backreference of the kid
+static void set_kid(lnode_t *node, int i, rect_t rect, void *kid){
+    node->rects[i] = rect;
+    node->kids[i] = kid;
+    if(node->isleaf){
+        ((split_t*)kid)->leafidx_node = node;
+    }else{
+        ((lnode_t*)kid)->parent = node;
+    }
+}
+
+static int kid_index(lnode_t *node, void *kid){
+    for(int i = 0; i < node->n; i++){
+        if(node->kids[i] == kid) return i;
+    }
+    // should never happen
+    return -1;
+}
+
+static void remove_kid(lnode_t *node, int i){
+    node->n--;
+    // fill the hole with the last entry
+    if(i != node->n){
+        set_kid(node, i, node->rects[node->n], node->kids[node->n]);
+    }
+}
+
+// recalculate the bounding boxes of every ancestor of a node
+static void fix_bboxes(lnode_t *node){
+    for(; node->parent; node = node->parent){
+        lnode_t *parent = node->parent;
+        parent->rects[kid_index(parent, node)] = node_bbox(node);
+    }
+}
+
+// descend to the leaf node which grows the least by adding rect
+static lnode_t *choose_leaf(lnode_t *node, rect_t rect){
+    while(!node->isleaf){
+        int best = 0;
+        int64_t best_growth = 0;
+        int64_t best_area = 0;
+        for(int i = 0; i < node->n; i++){
+            int64_t area = rect_area(node->rects[i]);
+            int64_t growth = rect_area(rect_union(node->rects[i], rect)) - area;
+            if(i == 0 || growth < best_growth
+                    || (growth == best_growth && area < best_area)){
+                best = i;
+                best_growth = growth;
+                best_area = area;
+            }
+        }
+        node = node->kids[best];
+    }
+    return node;
+}
+
+/* Distribute the entries of a full node, plus one extra entry, between the
+   node and an empty sibling.  Entries are sorted by their centers along
+   whichever axis they are most spread out on, then cut in half. */
+static void split_entries(lnode_t *node, lnode_t *sibling,
+                          rect_t rect, void *kid){
+    rect_t rects[NODE_MAX + 1];
+    void *kids[NODE_MAX + 1];
+    int n = 0;
+    for(int i = 0; i < node->n; i++){
+        rects[n] = node->rects[i];
+        kids[n++] = node->kids[i];
+    }
+    rects[n] = rect;
+    kids[n++] = kid;
+
+    // pick the axis (centers are doubled to stay in integers)
+    int64_t xmin = INT64_MAX, xmax = INT64_MIN;
+    int64_t ymin = INT64_MAX, ymax = INT64_MIN;
+    for(int i = 0; i < n; i++){
+        int64_t cx = (int64_t)rects[i].l + rects[i].r;
+        int64_t cy = (int64_t)rects[i].t + rects[i].b;
+        if(cx < xmin) xmin = cx;
+        if(cx > xmax) xmax = cx;
+        if(cy < ymin) ymin = cy;
+        if(cy > ymax) ymax = cy;
+    }
+    bool by_x = (xmax - xmin) >= (ymax - ymin);
+
+    // insertion sort, n is tiny
+    for(int i = 1; i < n; i++){
+        rect_t r = rects[i];
+        void *k = kids[i];
+        int64_t c = by_x ? (int64_t)r.l + r.r : (int64_t)r.t + r.b;
+        int j = i;
+        for(; j > 0; j--){
+            rect_t p = rects[j-1];
+            int64_t pc = by_x ? (int64_t)p.l + p.r : (int64_t)p.t + p.b;
+            if(pc <= c) break;
+            rects[j] = rects[j-1];
+            kids[j] = kids[j-1];
+        }
+        rects[j] = r;
+        kids[j] = k;
+    }
+
+    int half = n / 2;
+    node->n = 0;
+    sibling->n = 0;
+    for(int i = 0; i < half; i++){
+        set_kid(node, node->n++, rects[i], kids[i]);
+    }
+    for(int i = half; i < n; i++){
+        set_kid(sibling, sibling->n++, rects[i], kids[i]);
+    }
+}
+
+/* insert a split_t, assuming the caller already set leaf->rect.  Every node
+   which might be needed is allocated up front, so the tree is never left
+   half-modified on an allocation failure. */
+static int insert(leafindex_t *idx, split_t *leaf){
+    rect_t rect = leaf->rect;
+    lnode_t *node = choose_leaf(idx->root, rect);
+
+    // each full node on the path will split, and maybe the root too
+    lnode_t *spares[64];
+    int nspares = 0;
+    lnode_t *p = node;
+    for(; p && p->n == NODE_MAX; p = p->parent) nspares++;
+    if(!p) nspares++;
+    for(int i = 0; i < nspares; i++){
+        spares[i] = node_new(false);
+        if(!spares[i]){
+            for(int j = 0; j < i; j++) free(spares[j]);
+            return -1;
+        }
+    }
+
+    void *kid = leaf;
+    while(true){
+        if(node->n < NODE_MAX){
+            set_kid(node, node->n++, rect, kid);
+            fix_bboxes(node);
+            return 0;
+        }
+        // node is full, split it with a new sibling
+        lnode_t *sibling = spares[--nspares];
+        sibling->isleaf = node->isleaf;
+        split_entries(node, sibling, rect, kid);
+        if(!node->parent){
+            // grow a new root
+            lnode_t *root = spares[--nspares];
+            set_kid(root, root->n++, node_bbox(node), node);
+            set_kid(root, root->n++, node_bbox(sibling), sibling);
+            idx->root = root;
+            return 0;
+        }
+        lnode_t *parent = node->parent;
+        parent->rects[kid_index(parent, node)] = node_bbox(node);
+        // now the sibling has to be inserted into the parent
+        rect = node_bbox(sibling);
+        kid = sibling;
+        node = parent;
+    }
+}
+
+// reinsert every leaf of a node that was cut out of the tree, then free it
+static void reinsert_all(leafindex_t *idx, lnode_t *node){
+    for(int i = 0; i < node->n; i++){
+        if(node->isleaf){
+            split_t *leaf = node->kids[i];
+            leaf->leafidx_node = NULL;
+            if(insert(idx, leaf)){
+                logmsg("no memory to reinsert leaf into leafindex\n");
+            }
+        }else{
+            reinsert_all(idx, node->kids[i]);
+        }
+    }
+    free(node);
+}
+
+// after removing from a node, cut out underfull nodes and fix the bboxes
+static void condense(leafindex_t *idx, lnode_t *node){
+    // orphaned nodes are chained together through their parent pointers
+    lnode_t *orphans = NULL;
+    while(node->parent){
+        lnode_t *parent = node->parent;
+        if(node->n < NODE_MIN){
+            remove_kid(parent, kid_index(parent, node));
+            node->parent = orphans;
+            orphans = node;
+        }else{
+            parent->rects[kid_index(parent, node)] = node_bbox(node);
+        }
+        node = parent;
+    }
+    // a root with only one child is replaced by that child
+    while(!idx->root->isleaf && idx->root->n == 1){
+        lnode_t *old = idx->root;
+        idx->root = old->kids[0];
+        idx->root->parent = NULL;
+        free(old);
+    }
+    // an empty root is just an empty leaf
+    if(idx->root->n == 0) idx->root->isleaf = true;
+    // put the orphaned leaves back
+    while(orphans){
+        lnode_t *next = orphans->parent;
+        reinsert_all(idx, orphans);
+        orphans = next;
+    }
+}
+
+static void free_nodes(lnode_t *node){
+    for(int i = 0; i < node->n; i++){
+        if(node->isleaf){
+            ((split_t*)node->kids[i])->leafidx_node = NULL;
+        }else{
+            free_nodes(node->kids[i]);
+        }
+    }
+    free(node);
+}
+
+leafindex_t *leafindex_new(void){
+    leafindex_t *idx = malloc(sizeof(*idx));
+    if(!idx) return NULL;
+    idx->root = node_new(true);
+    if(!idx->root){
+        free(idx);
+        return NULL;
+    }
+    return idx;
+}
+
+void leafindex_free(leafindex_t *idx){
+    if(!idx) return;
+    free_nodes(idx->root);
+    free(idx);
+}
+
+int leafindex_set(leafindex_t *idx, split_t *leaf, rect_t rect){
+    if(leaf->leafidx_node){
+        rect_t old = leaf->rect;
+        if(old.t == rect.t && old.b == rect.b
+                && old.l == rect.l && old.r == rect.r){
+            return 0;
+        }
+        leafindex_remove(idx, leaf);
+    }
+    leaf->rect = rect;
+    return insert(idx, leaf);
+}
+
+void leafindex_remove(leafindex_t *idx, split_t *leaf){
+    lnode_t *node = leaf->leafidx_node;
+    if(!node) return;
+    remove_kid(node, kid_index(node, leaf));
+    leaf->leafidx_node = NULL;
+    condense(idx, node);
+}
+
+void leafindex_clear(leafindex_t *idx){
+    lnode_t *root = node_new(true);
+    if(!root){
+        // can't swap in a fresh root, so empty the tree one leaf at a time
+        while(idx->root->n){
+            lnode_t *node = idx->root;
+            while(!node->isleaf) node = node->kids[0];
+            leafindex_remove(idx, node->kids[0]);
+        }
+        return;
+    }
+    free_nodes(idx->root);
+    idx->root = root;
+}
+
+static split_t *node_at(lnode_t *node, int32_t x, int32_t y){
+    for(int i = 0; i < node->n; i++){
+        if(!rect_contains(node->rects[i], x, y)) continue;
+        if(node->isleaf) return node->kids[i];
+        split_t *out = node_at(node->kids[i], x, y);
+        if(out) return out;
+    }
+    return NULL;
+}
+
+split_t *leafindex_at(leafindex_t *idx, int32_t x, int32_t y){
+    return node_at(idx->root, x, y);
+}
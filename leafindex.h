@@ -0,0 +1,33 @@
+#ifndef LEAFINDEX_H
+#define LEAFINDEX_H
+
+#include "venowm.h"
+
+/* The leafindex is a spatial index of leaf frames, keyed by the rectangles
+   (in global coordinates) they were last drawn to.  It covers every root of a
+   workspace, so it can answer "which frame is at this point" across screens.
+
+   Internally it is a small R-tree, so lookups stay logarithmic in the number
+   of frames, and frames can be added, moved, or removed individually. */
+
+leafindex_t *leafindex_new(void);
+void leafindex_free(leafindex_t *idx);
+
+// add a leaf to the index, or move it if it is already indexed
+// returns 0 for OK or -1 for error (then the leaf is not indexed)
+int leafindex_set(leafindex_t *idx, split_t *leaf, rect_t rect);
+
+// noop if the leaf is not indexed
+void leafindex_remove(leafindex_t *idx, split_t *leaf);
+
+// remove every leaf from the index
+void leafindex_clear(leafindex_t *idx);
+
+// returns the leaf whose rectangle contains (x,y), or NULL if there is none
+split_t *leafindex_at(leafindex_t *idx, int32_t x, int32_t y);
+
+static inline bool rect_contains(rect_t rect, int32_t x, int32_t y){
+    return x >= rect.l && x < rect.r && y >= rect.t && y < rect.b;
+}
+
+#endif // LEAFINDEX_H
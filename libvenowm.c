@@ -16,6 +16,11 @@ struct venowm {
     char errmsg[1024];
     // the wayland interface to the venowm_control protocol
     struct venowm_control *venowm_control;
+    // callbacks for events in response to the current query
+    venowm_alloc_stats_cb_t alloc_stats_cb;
+    venowm_search_cb_t search_cb;
+    venowm_client_stats_cb_t client_stats_cb;
+    void *cb_data;
 };
 
 // like snprintf(v->errmsg, sizeof(v->errmsg), fmt, ...), but safe and concise
@@ -35,12 +40,63 @@ static inline void errmsg(struct venowm *v, const char *fmt, ...){
     v->failed = true;
 }
 
+static void control_handle_alloc_stats(void *data,
+        struct venowm_control *venowm_control, const char *name,
+        uint32_t size, uint32_t live, uint32_t peak){
+    struct venowm *v = data;
+
+    if(v->alloc_stats_cb){
+        v->alloc_stats_cb(v->cb_data, name, size, live, peak);
+    }
+}
+
+static void control_handle_search_result(void *data,
+        struct venowm_control *venowm_control, uint32_t id_hi, uint32_t id_lo,
+        const char *workspace, const char *app_id, const char *title,
+        uint32_t score){
+    struct venowm *v = data;
+
+    if(v->search_cb){
+        v->search_cb(v->cb_data, (uint64_t)id_hi << 32 | id_lo, workspace,
+                     app_id, title, score);
+    }
+}
+
+static void control_handle_client_stats(void *data,
+        struct venowm_control *venowm_control, uint32_t pid,
+        const char *app_id, uint32_t surfaces, uint32_t buffer_kb,
+        uint32_t commits, uint32_t frames, uint32_t configure_avg_us,
+        uint32_t configure_max_us){
+    struct venowm *v = data;
+
+    if(v->client_stats_cb){
+        struct venowm_client_stats stats = {
+            .pid = pid,
+            .app_id = app_id,
+            .surfaces = surfaces,
+            .buffer_kb = buffer_kb,
+            .commits_per_sec = commits,
+            .frames_per_sec = frames,
+            .configure_avg_us = configure_avg_us,
+            .configure_max_us = configure_max_us,
+        };
+        v->client_stats_cb(v->cb_data, &stats);
+    }
+}
+
+static const struct venowm_control_listener control_listener = {
+    control_handle_alloc_stats,
+    control_handle_search_result,
+    control_handle_client_stats,
+};
+
 static void registry_handle_global(void *data, struct wl_registry *registry,
         uint32_t uid, const char *interface, uint32_t version){
     struct venowm *v = data;
 
     if(strcmp(interface, "venowm_control") == 0){
         v->venowm_control = wl_registry_bind(registry, uid, &venowm_control_interface, 1);
+        venowm_control_add_listener(v->venowm_control, &control_listener, v);
         v->global_uid = uid;
         v->connected = true;
     }
@@ -180,6 +236,226 @@ int venowm_focus_right(struct venowm *v, bool flush){
     return do_venowm_command(v, flush, venowm_control_focus_right);
 }
 
+int venowm_focus_next(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_focus_next);
+}
+
+int venowm_focus_prev(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_focus_prev);
+}
+
+int venowm_only(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_only);
+}
+
+int venowm_tile_hidden(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_tile_hidden);
+}
+
+int venowm_undo(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_undo);
+}
+
+int venowm_redo(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_redo);
+}
+
+int venowm_save_layout(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_save_layout);
+}
+
+int venowm_switch_workspace(struct venowm *v, const char *name, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_switch_workspace(v->venowm_control, name);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_bring_app_id(struct venowm *v, const char *app_id, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_bring_app_id(v->venowm_control, app_id);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_bring_title(struct venowm *v, const char *title, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_bring_title(v->venowm_control, title);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_search_windows(struct venowm *v, const char *query, uint32_t max,
+        venowm_search_cb_t cb, void *data){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    v->search_cb = cb;
+    v->cb_data = data;
+
+    venowm_control_search_windows(v->venowm_control, query, max);
+
+    // all of the events arrive before the roundtrip completes
+    int ret = wl_display_roundtrip(v->display);
+
+    v->search_cb = NULL;
+    v->cb_data = NULL;
+
+    if(ret < 0){
+        errmsg(v, "failed to sync with display server");
+        return -1;
+    }
+
+    return 0;
+}
+
+int venowm_goto_window(struct venowm *v, const char *query, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_goto_window(v->venowm_control, query);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_last_window(struct venowm *v, bool flush){
+    return do_venowm_command(v, flush, venowm_control_last_window);
+}
+
+int venowm_move_to_workspace(struct venowm *v, const char *name, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_move_to_workspace(v->venowm_control, name);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_copy_to_workspace(struct venowm *v, const char *name, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_copy_to_workspace(v->venowm_control, name);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_focus_window(struct venowm *v, uint64_t id, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_focus_window(v->venowm_control, (uint32_t)(id >> 32),
+            (uint32_t)id);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_close_window(struct venowm *v, uint64_t id, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_close_window(v->venowm_control, (uint32_t)(id >> 32),
+            (uint32_t)id);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_window_to_workspace(struct venowm *v, uint64_t id,
+        const char *name, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_window_to_workspace(v->venowm_control,
+            (uint32_t)(id >> 32), (uint32_t)id, name);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_window_to_frame(struct venowm *v, uint64_t id, uint32_t frame,
+        bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_window_to_frame(v->venowm_control, (uint32_t)(id >> 32),
+            (uint32_t)id, frame);
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
+int venowm_resize(struct venowm *v, double dx, double dy, bool flush){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    venowm_control_resize(v->venowm_control, wl_fixed_from_double(dx),
+            wl_fixed_from_double(dy));
+
+    if(!flush) return 0;
+
+    return venowm_flush(v);
+}
+
 int venowm_launch(struct venowm *v, int argc, char **argv){
     int retval = 0;
 
@@ -246,3 +522,57 @@ cu_arrays:
     wl_array_release(&argvlen_array);
     return retval;
 }
+
+int venowm_alloc_stats(struct venowm *v, venowm_alloc_stats_cb_t cb,
+        void *data){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    v->alloc_stats_cb = cb;
+    v->cb_data = data;
+
+    venowm_control_get_alloc_stats(v->venowm_control);
+
+    // all of the events arrive before the roundtrip completes
+    int ret = wl_display_roundtrip(v->display);
+
+    v->alloc_stats_cb = NULL;
+    v->cb_data = NULL;
+
+    if(ret < 0){
+        errmsg(v, "failed to sync with display server");
+        return -1;
+    }
+
+    return 0;
+}
+
+int venowm_client_stats(struct venowm *v, venowm_client_stats_cb_t cb,
+        void *data){
+    if(v->failed) return -1;
+    if(!v->connected){
+        errmsg(v, "not connected yet!");
+        return -1;
+    }
+
+    v->client_stats_cb = cb;
+    v->cb_data = data;
+
+    venowm_control_get_client_stats(v->venowm_control);
+
+    // all of the events arrive before the roundtrip completes
+    int ret = wl_display_roundtrip(v->display);
+
+    v->client_stats_cb = NULL;
+    v->cb_data = NULL;
+
+    if(ret < 0){
+        errmsg(v, "failed to sync with display server");
+        return -1;
+    }
+
+    return 0;
+}
@@ -28,8 +28,80 @@ int venowm_focus_up(struct venowm *v, bool flush);
 int venowm_focus_down(struct venowm *v, bool flush);
 int venowm_focus_left(struct venowm *v, bool flush);
 int venowm_focus_right(struct venowm *v, bool flush);
+int venowm_focus_next(struct venowm *v, bool flush);
+int venowm_focus_prev(struct venowm *v, bool flush);
+int venowm_only(struct venowm *v, bool flush);
+int venowm_tile_hidden(struct venowm *v, bool flush);
+int venowm_undo(struct venowm *v, bool flush);
+int venowm_redo(struct venowm *v, bool flush);
+// write the layout file right away
+int venowm_save_layout(struct venowm *v, bool flush);
+
+/* show a workspace by name (numbered workspaces are named "1", "2", ...),
+   which is created if it doesn't exist yet */
+int venowm_switch_workspace(struct venowm *v, const char *name, bool flush);
+/* show the hidden window with the given app_id (or title) in the focused
+   frame, if there is one */
+int venowm_bring_app_id(struct venowm *v, const char *app_id, bool flush);
+int venowm_bring_title(struct venowm *v, const char *title, bool flush);
+// go back to the previously focused window, like alt-tab
+int venowm_last_window(struct venowm *v, bool flush);
+// send the focused window to a workspace, or show it there too
+int venowm_move_to_workspace(struct venowm *v, const char *name, bool flush);
+int venowm_copy_to_workspace(struct venowm *v, const char *name, bool flush);
+
+/* move the borders of the focused frame, by fractions of its parent split;
+   negative amounts move them left or up */
+int venowm_resize(struct venowm *v, double dx, double dy, bool flush);
 
 /* tell venowm to launch a command */
 int venowm_launch(struct venowm *v, int argc, char **argv);
 
+/* Ask venowm for allocator statistics.  The callback is called once per type
+   of object before venowm_alloc_stats returns. */
+typedef void (*venowm_alloc_stats_cb_t)(void *data, const char *name,
+        uint32_t size, uint32_t live, uint32_t peak);
+int venowm_alloc_stats(struct venowm *v, venowm_alloc_stats_cb_t cb,
+        void *data);
+
+/* Find windows on every workspace by a few characters of their app_id or
+   title.  The callback is called once per match, best first, before
+   venowm_search_windows returns.  id names the window in the calls below,
+   for as long as the window is open. */
+typedef void (*venowm_search_cb_t)(void *data, uint64_t id,
+        const char *workspace, const char *app_id, const char *title,
+        uint32_t score);
+int venowm_search_windows(struct venowm *v, const char *query, uint32_t max,
+        venowm_search_cb_t cb, void *data);
+// show the best match for a search, wherever it is
+int venowm_goto_window(struct venowm *v, const char *query, bool flush);
+
+/* Act on one window by its id, without moving the focus there step by step.
+   Ids of windows which have closed are ignored.  Frames count from 1. */
+int venowm_focus_window(struct venowm *v, uint64_t id, bool flush);
+int venowm_close_window(struct venowm *v, uint64_t id, bool flush);
+int venowm_window_to_workspace(struct venowm *v, uint64_t id,
+        const char *name, bool flush);
+int venowm_window_to_frame(struct venowm *v, uint64_t id, uint32_t frame,
+        bool flush);
+
+/* Ask venowm what each connected client is costing.  The callback is called
+   once per client before venowm_client_stats returns.  Rates are for the
+   last full second, and app_id is empty for a client without windows. */
+struct venowm_client_stats {
+    uint32_t pid;
+    const char *app_id;
+    uint32_t surfaces;
+    uint32_t buffer_kb;
+    uint32_t commits_per_sec;
+    uint32_t frames_per_sec;
+    // from sending a window a size until it draws at that size
+    uint32_t configure_avg_us;
+    uint32_t configure_max_us;
+};
+typedef void (*venowm_client_stats_cb_t)(void *data,
+        const struct venowm_client_stats *stats);
+int venowm_client_stats(struct venowm *v, venowm_client_stats_cb_t cb,
+        void *data);
+
 #endif // LIBVENOWM_H
@@ -0,0 +1,225 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <regex.h>
+
+#include "rules.h"
+
+// regexes are tried one at a time, so don't let there be too many
+#define MAX_REGEX 64
+
+#define SEPS " \t\n"
+
+enum {
+    FIELD_APP_ID,
+    FIELD_TITLE,
+};
+
+typedef struct rule_t {
+    int field;
+    bool isregex;
+    // the text to match, and its compiled form for regex rules
+    char *text;
+    regex_t re;
+    char *workspace;
+    rule_target_t target;
+    // every rule, in file order
+    struct rule_t *next;
+} rule_t;
+
+KHASH_MAP_INIT_STR(rule, rule_t*)
+
+static rule_t *rules = NULL;
+static rule_t **rules_tail = &rules;
+// exact rules, by text, for each field
+static khash_t(rule) *exact[2] = {NULL, NULL};
+// regex rules, in file order
+static rule_t *regexes[MAX_REGEX];
+static size_t nregexes = 0;
+
+// returns NULL if there is nowhere to keep the file
+static const char *get_path(char *buf, size_t size){
+    const char *home = getenv("HOME");
+    if(!home) return NULL;
+    int len = snprintf(buf, size, "%s/.venowm-rules", home);
+    if(len < 0 || (size_t)len >= size) return NULL;
+    return buf;
+}
+
+static void rule_free(rule_t *rule){
+    if(rule->isregex) regfree(&rule->re);
+    free(rule->text);
+    free(rule->workspace);
+    free(rule);
+}
+
+void rules_free(void){
+    while(rules){
+        rule_t *next = rules->next;
+        rule_free(rules);
+        rules = next;
+    }
+    rules_tail = &rules;
+    for(int i = 0; i < 2; i++){
+        // the keys belong to the rules
+        if(exact[i]) kh_destroy(rule, exact[i]);
+        exact[i] = NULL;
+    }
+    nregexes = 0;
+}
+
+// parse "NAME", "NAME:N" or "NAME:hidden", returns -1 for a bad target
+static int read_target(rule_t *rule, char *tok){
+    rule->target = (rule_target_t){.frame = SIZE_MAX};
+    char *colon = strchr(tok, ':');
+    if(colon){
+        *colon = '\0';
+        char *where = colon + 1;
+        if(strcmp(where, "hidden") == 0){
+            rule->target.hidden = true;
+        }else{
+            char *end;
+            unsigned long n = strtoul(where, &end, 10);
+            if(!*where || *end || n < 1 || n >= SIZE_MAX) return -1;
+            rule->target.frame = (size_t)n - 1;
+        }
+    }
+    if(!*tok) return -1;
+    if(strcmp(tok, ".") == 0) return 0;
+    rule->workspace = strdup(tok);
+    if(!rule->workspace) return -1;
+    rule->target.workspace = rule->workspace;
+    return 0;
+}
+
+// trim whitespace off both ends of the rest of a line
+static char *trim(char *s){
+    while(*s && strchr(SEPS, *s)) s++;
+    size_t len = strlen(s);
+    while(len && strchr(SEPS, s[len - 1])) s[--len] = '\0';
+    return s;
+}
+
+// parse one line, returns NULL for a bad line
+static rule_t *read_rule(char *field, char **save){
+    rule_t *rule = malloc(sizeof(*rule));
+    if(!rule) return NULL;
+    *rule = (rule_t){0};
+
+    size_t flen = strlen(field);
+    if(flen && field[flen - 1] == '~'){
+        rule->isregex = true;
+        field[flen - 1] = '\0';
+    }
+    if(strcmp(field, "app_id") == 0){
+        rule->field = FIELD_APP_ID;
+    }else if(strcmp(field, "title") == 0){
+        rule->field = FIELD_TITLE;
+    }else{
+        goto fail;
+    }
+
+    char *target = strtok_r(NULL, SEPS, save);
+    if(!target || read_target(rule, target)) goto fail;
+
+    char *text = *save ? trim(*save) : "";
+    if(!*text) goto fail;
+    rule->text = strdup(text);
+    if(!rule->text) goto fail;
+    if(rule->isregex){
+        if(regcomp(&rule->re, rule->text, REG_EXTENDED | REG_NOSUB)){
+            // nothing to regfree()
+            rule->isregex = false;
+            goto fail;
+        }
+    }
+    return rule;
+
+fail:
+    rule_free(rule);
+    return NULL;
+}
+
+// file the rule where rules_match() will look for it
+static int add_rule(rule_t *rule){
+    if(rule->isregex){
+        if(nregexes == MAX_REGEX) return -1;
+        regexes[nregexes++] = rule;
+    }else{
+        int ret;
+        khiter_t k = kh_put(rule, exact[rule->field], rule->text, &ret);
+        if(ret < 0) return -1;
+        // the first rule for the same text wins
+        if(ret) kh_value(exact[rule->field], k) = rule;
+    }
+    *rules_tail = rule;
+    rules_tail = &rule->next;
+    return 0;
+}
+
+int rules_load(void){
+    for(int i = 0; i < 2; i++){
+        exact[i] = kh_init(rule);
+        if(!exact[i]){
+            rules_free();
+            return -1;
+        }
+    }
+
+    char path[PATH_MAX];
+    if(!get_path(path, sizeof(path))) return 0;
+    FILE *f = fopen(path, "r");
+    // no rules, nothing to do
+    if(!f) return 0;
+
+    int retval = 0;
+    char *line = NULL;
+    size_t size = 0;
+    size_t lineno = 0;
+    while(getline(&line, &size, f) >= 0){
+        lineno++;
+        char *save;
+        char *tok = strtok_r(line, SEPS, &save);
+        if(!tok || tok[0] == '#') continue;
+        rule_t *rule = read_rule(tok, &save);
+        if(!rule){
+            logmsg("%s:%zu: bad rule\n", path, lineno);
+            continue;
+        }
+        if(add_rule(rule)){
+            logmsg("%s:%zu: unable to add rule\n", path, lineno);
+            rule_free(rule);
+        }
+    }
+    if(ferror(f)){
+        logmsg("unable to read %s\n", path);
+        retval = -1;
+    }
+    free(line);
+    fclose(f);
+    return retval;
+}
+
+static rule_t *get_exact(int field, const char *text){
+    if(!text || !exact[field]) return NULL;
+    khiter_t k = kh_get(rule, exact[field], text);
+    if(k == kh_end(exact[field])) return NULL;
+    return kh_value(exact[field], k);
+}
+
+bool rules_match(const char *app_id, const char *title, rule_target_t *out){
+    rule_t *rule = get_exact(FIELD_APP_ID, app_id);
+    if(!rule) rule = get_exact(FIELD_TITLE, title);
+    for(size_t i = 0; !rule && i < nregexes; i++){
+        const char *text = regexes[i]->field == FIELD_APP_ID ? app_id : title;
+        if(regexec(&regexes[i]->re, text ? text : "", 0, NULL, 0) == 0){
+            rule = regexes[i];
+        }
+    }
+    if(!rule) return false;
+    *out = rule->target;
+    return true;
+}
@@ -0,0 +1,55 @@
+#ifndef RULES_H
+#define RULES_H
+
+#include "venowm.h"
+
+/* Placement rules decide where a new window goes, by its app_id or title.
+   They are read once at startup from ~/.venowm-rules, one rule per line:
+
+       <field> <target> <text>
+
+   <field> is "app_id" or "title" for an exact match, or "app_id~" or
+   "title~" for a POSIX extended regex.  <text> is the rest of the line, so
+   it may have spaces in it.  <target> is one of:
+
+       NAME           workspace NAME, in its focused frame if that is empty,
+                      or else hidden
+       NAME:N         the Nth frame of workspace NAME, counting from 1
+       NAME:hidden    hidden on workspace NAME
+
+   where NAME is "." for whichever workspace is showing.  For example:
+
+       app_id   web          firefox
+       title    .:hidden     Picture-in-Picture
+       app_id~  chat:2       ^(slack|discord)$
+
+   The exact rules are kept in hash tables, so they cost the same no matter
+   how many there are.  Regexes are tried one by one, in file order, and only
+   if no exact rule matched, so there should only be a few.  The first rule
+   in the file wins when two exact rules have the same text, and an app_id
+   rule wins over a title rule.
+
+   Rules are checked once, on the window's first commit, so that it is sent
+   its frame's size before it draws anything.  Most windows set their title
+   and app_id before that, and a title the window sets later doesn't move
+   it. */
+
+typedef struct {
+    // name of the workspace, or NULL for the one that's showing
+    const char *workspace;
+    // which frame (from 0), or SIZE_MAX for the focused frame
+    size_t frame;
+    bool hidden;
+} rule_target_t;
+
+/* Read the rules file.  A missing file is not an error.  Bad lines are
+   logged and skipped.  Returns 0, or -1 if the file couldn't be read. */
+int rules_load(void);
+void rules_free(void);
+
+/* Find the rule for a window, either string may be NULL.  The target points
+   into the rules, so it is good until rules_free().  Returns false if no
+   rule matched. */
+bool rules_match(const char *app_id, const char *title, rule_target_t *out);
+
+#endif // RULES_H
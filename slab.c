@@ -0,0 +1,155 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdalign.h>
+
+#include "slab.h"
+#include "logmsg.h"
+
+/* Chunks are aligned to their own size, so the chunk header of any object is
+   found by masking off the low bits of its address. */
+#define CHUNK_SIZE 4096
+
+typedef struct slab_chunk_t {
+    slab_t *slab;
+    struct slab_chunk_t *prev;
+    struct slab_chunk_t *next;
+    // freed objects, chained together through their first word
+    void *free;
+    size_t live;
+    // objects past this index have never been handed out
+    size_t unused;
+    size_t capacity;
+} slab_chunk_t;
+
+#define ALIGN_UP(x, a) (((x) + (a) - 1) / (a) * (a))
+
+// objects start after the header
+#define CHUNK_HEADER ALIGN_UP(sizeof(slab_chunk_t), alignof(max_align_t))
+
+static slab_type_t *registry = NULL;
+
+static void register_type(slab_type_t *type){
+    if(type->registered) return;
+    type->registered = true;
+    type->next = registry;
+    registry = type;
+}
+
+static size_t obj_size(slab_type_t *type){
+    size_t size = type->size < sizeof(void*) ? sizeof(void*) : type->size;
+    return ALIGN_UP(size, alignof(max_align_t));
+}
+
+static slab_chunk_t *chunk_of(void *ptr){
+    return (slab_chunk_t*)((uintptr_t)ptr & ~(uintptr_t)(CHUNK_SIZE - 1));
+}
+
+static void *chunk_obj(slab_chunk_t *chunk, size_t i){
+    return (char*)chunk + CHUNK_HEADER + i * obj_size(chunk->slab->type);
+}
+
+static void list_remove(slab_chunk_t **head, slab_chunk_t *chunk){
+    if(chunk->prev) chunk->prev->next = chunk->next;
+    else *head = chunk->next;
+    if(chunk->next) chunk->next->prev = chunk->prev;
+    chunk->prev = NULL;
+    chunk->next = NULL;
+}
+
+static void list_push(slab_chunk_t **head, slab_chunk_t *chunk){
+    chunk->prev = NULL;
+    chunk->next = *head;
+    if(*head) (*head)->prev = chunk;
+    *head = chunk;
+}
+
+static slab_chunk_t *chunk_new(slab_t *slab){
+    slab_chunk_t *chunk = aligned_alloc(CHUNK_SIZE, CHUNK_SIZE);
+    if(!chunk) return NULL;
+    *chunk = (slab_chunk_t){
+        .slab = slab,
+        .capacity = (CHUNK_SIZE - CHUNK_HEADER) / obj_size(slab->type),
+    };
+    return chunk;
+}
+
+void slab_init(slab_t *slab, slab_type_t *type){
+    *slab = (slab_t){.type = type};
+    register_type(type);
+}
+
+static void free_chunks(slab_chunk_t *chunk){
+    while(chunk){
+        slab_chunk_t *next = chunk->next;
+        if(chunk->live){
+            logmsg("slab: %zu leaked %s objects\n", chunk->live,
+                   chunk->slab->type->name);
+            chunk->slab->type->live -= chunk->live;
+        }
+        free(chunk);
+        chunk = next;
+    }
+}
+
+void slab_deinit(slab_t *slab){
+    free_chunks(slab->partial);
+    free_chunks(slab->full);
+    slab->partial = NULL;
+    slab->full = NULL;
+}
+
+void *slab_alloc(slab_t *slab){
+    // statically initialized slabs get registered here
+    register_type(slab->type);
+    slab_chunk_t *chunk = slab->partial;
+    if(!chunk){
+        chunk = chunk_new(slab);
+        if(!chunk) return NULL;
+        list_push(&slab->partial, chunk);
+    }
+    void *out;
+    if(chunk->free){
+        out = chunk->free;
+        chunk->free = *(void**)out;
+    }else{
+        out = chunk_obj(chunk, chunk->unused++);
+    }
+    chunk->live++;
+    // move full chunks out of the way
+    if(!chunk->free && chunk->unused == chunk->capacity){
+        list_remove(&slab->partial, chunk);
+        list_push(&slab->full, chunk);
+    }
+    // update stats
+    slab_type_t *type = slab->type;
+    if(++type->live > type->peak) type->peak = type->live;
+    return out;
+}
+
+void slab_free(void *ptr){
+    if(!ptr) return;
+    slab_chunk_t *chunk = chunk_of(ptr);
+    slab_t *slab = chunk->slab;
+    bool was_full = (!chunk->free && chunk->unused == chunk->capacity);
+    *(void**)ptr = chunk->free;
+    chunk->free = ptr;
+    chunk->live--;
+    slab->type->live--;
+    if(was_full){
+        list_remove(&slab->full, chunk);
+        list_push(&slab->partial, chunk);
+    }
+    // release empty chunks, but keep one around to avoid thrashing
+    if(chunk->live == 0 && (chunk->prev || chunk->next)){
+        list_remove(&slab->partial, chunk);
+        free(chunk);
+    }
+}
+
+slab_t *slab_of(void *ptr){
+    return chunk_of(ptr)->slab;
+}
+
+slab_type_t *slab_types(void){
+    return registry;
+}
@@ -0,0 +1,51 @@
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+/* A slab is a pool of fixed-size objects, carved out of page-sized chunks.
+   Objects allocated from the same slab end up next to each other in memory,
+   so giving each workspace its own slab keeps its split tree compact.
+
+   Every slab belongs to a slab_type_t, which keeps live and peak object counts
+   across all the slabs of that type. */
+
+typedef struct slab_type_t {
+    const char *name;
+    size_t size;
+    // objects currently allocated, and the most ever allocated at once
+    size_t live;
+    size_t peak;
+    // list of every slab_type_t which has been used (see slab_types())
+    bool registered;
+    struct slab_type_t *next;
+} slab_type_t;
+
+#define SLAB_TYPE(type) { .name = #type, .size = sizeof(type) }
+
+struct slab_chunk_t;
+
+typedef struct {
+    slab_type_t *type;
+    // chunks with room for more objects, and chunks without
+    struct slab_chunk_t *partial;
+    struct slab_chunk_t *full;
+} slab_t;
+
+// a slab may also be statically initialized as (slab_t){.type = &type}
+void slab_init(slab_t *slab, slab_type_t *type);
+// release all memory; objects which were not freed are invalidated
+void slab_deinit(slab_t *slab);
+
+// returns uninitialized memory, or NULL on error
+void *slab_alloc(slab_t *slab);
+// the object remembers which slab it came from
+void slab_free(void *ptr);
+// find the slab an object came from
+slab_t *slab_of(void *ptr);
+
+// get the first slab_type_t which has been used, follow ->next for the rest
+slab_type_t *slab_types(void);
+
+#endif // SLAB_H
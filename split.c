@@ -1,127 +1,582 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "split.h"
 #include "window.h"
 
-split_t *split_new(split_t *parent){
-    split_t *out = malloc(sizeof(*out));
+slab_type_t split_slab_type = SLAB_TYPE(split_t);
+
+// for split_t.id
+static uint64_t last_id = 0;
+
+split_t *split_new(slab_t *slab, split_t *parent){
+    split_t *out = slab_alloc(slab);
     if(!out) return NULL;
     out->isvertical = false;
-    out->fraction = 1.0;
     out->parent = parent;
-    out->frames[0] = NULL;
-    out->frames[1] = NULL;
+    out->idx = 0;
+    out->frames = NULL;
+    out->bounds = NULL;
+    out->frames_cap = 0;
+    out->nframes = 0;
     out->isleaf = true;
     out->win_info = NULL;
-    out->screen = parent ? parent->screen : NULL;
+    out->screen = NULL;
+    out->prev_leaf = NULL;
+    out->next_leaf = NULL;
+    out->rect = (rect_t){0};
+    out->leafidx_node = NULL;
+    out->snap = NULL;
+    out->screen_id = NULL;
+    out->focused = 0;
+    out->id = ++last_id;
     return out;
 }
 
+// put *new in the thread of leaves right after *leaf
+static void leaf_insert_after(split_t *leaf, split_t *new){
+    new->prev_leaf = leaf;
+    new->next_leaf = leaf->next_leaf;
+    if(leaf->next_leaf) leaf->next_leaf->prev_leaf = new;
+    leaf->next_leaf = new;
+}
+
+// put *new in the thread of leaves in place of *old
+static void leaf_replace(split_t *old, split_t *new){
+    new->prev_leaf = old->prev_leaf;
+    new->next_leaf = old->next_leaf;
+    if(old->prev_leaf) old->prev_leaf->next_leaf = new;
+    if(old->next_leaf) old->next_leaf->prev_leaf = new;
+    old->prev_leaf = NULL;
+    old->next_leaf = NULL;
+}
+
+// cut all of the leaves under *split out of the thread
+static void leaf_unlink(split_t *split){
+    split_t *first = split_first_leaf(split);
+    split_t *last = split_last_leaf(split);
+    if(first->prev_leaf) first->prev_leaf->next_leaf = last->next_leaf;
+    if(last->next_leaf) last->next_leaf->prev_leaf = first->prev_leaf;
+    first->prev_leaf = NULL;
+    last->next_leaf = NULL;
+}
+
+// free just this split_t, not its children
+static void free_node(split_t *split){
+    snap_unref(split->snap);
+    free(split->frames);
+    free(split->bounds);
+    free(split->screen_id);
+    slab_free(split);
+}
+
 // frees all the split_t objects, closing windows that are left
 void split_free(split_t *split){
     if(!split) return;
     // win_info should be empty here.  If it's not, we can't fix it now
-    split_free(split->frames[0]);
-    split_free(split->frames[1]);
-    free(split);
+    leaf_unlink(split);
+    /* Free without recursion: descend to a last child until reaching a split
+       with no children left, free it, and go back up to its parent. */
+    split_t *here = split;
+    while(true){
+        if(here->nframes){
+            here = here->frames[here->nframes - 1];
+            continue;
+        }
+        split_t *parent = here->parent;
+        bool done = (here == split);
+        free_node(here);
+        if(done) break;
+        // we always free the last child
+        parent->nframes--;
+        here = parent;
+    }
+}
+
+void snap_unref(snap_t *snap){
+    if(!snap || --snap->refs > 0) return;
+    for(size_t i = 0; i < snap->nframes; i++){
+        snap_unref(snap->frames[i]);
+    }
+    free(snap);
+}
+
+// allocate a snap_t with room for n children (and their bounds)
+snap_t *snap_new(size_t n){
+    snap_t *snap = malloc(sizeof(*snap) + sizeof(*snap->frames) * n
+                          + sizeof(*snap->bounds) * (n ? n + 1 : 0));
+    if(!snap) return NULL;
+    snap->refs = 1;
+    snap->nframes = 0;
+    snap->bounds = (float*)&snap->frames[n];
+    return snap;
+}
+
+snap_t *split_snapshot(split_t *split){
+    // an unchanged subtree shares its last snapshot
+    if(split->snap){
+        split->snap->refs++;
+        return split->snap;
+    }
+    snap_t *snap = snap_new(split->nframes);
+    if(!snap) return NULL;
+    snap->isleaf = split->isleaf;
+    snap->isvertical = split->isvertical;
+    snap->window = split->win_info ? split->win_info->window->handle : 0;
+    for(size_t i = 0; i < split->nframes; i++){
+        snap_t *kid = split_snapshot(split->frames[i]);
+        if(!kid){
+            snap_unref(snap);
+            return NULL;
+        }
+        snap->frames[snap->nframes++] = kid;
+        snap->bounds[i] = split->bounds[i];
+    }
+    if(split->nframes) snap->bounds[split->nframes] = 1.0;
+    // keep one reference in the cache
+    snap->refs++;
+    split->snap = snap;
+    return snap;
 }
 
-// returns 0 for OK, -1 for error
-/* first child inherits any window or global focus, but redrawing that window
+void split_touch(split_t *split){
+    for(; split; split = split->parent){
+        snap_unref(split->snap);
+        split->snap = NULL;
+    }
+}
+
+bool snap_equal(snap_t *a, snap_t *b){
+    if(a == b) return true;
+    if(a->isleaf != b->isleaf || a->nframes != b->nframes) return false;
+    if(a->isleaf) return a->window == b->window;
+    if(a->isvertical != b->isvertical) return false;
+    for(size_t i = 0; i < a->nframes; i++){
+        if(a->bounds[i] != b->bounds[i]) return false;
+        if(!snap_equal(a->frames[i], b->frames[i])) return false;
+    }
+    return true;
+}
+
+// make room for at least n children, returns 0 or -1
+static int reserve_frames(split_t *split, size_t n){
+    if(n <= split->frames_cap) return 0;
+    size_t cap = split->frames_cap ? split->frames_cap : 2;
+    while(cap < n) cap *= 2;
+    split_t **frames = realloc(split->frames, sizeof(*frames) * cap);
+    if(!frames) return -1;
+    split->frames = frames;
+    float *bounds = realloc(split->bounds, sizeof(*bounds) * (cap + 1));
+    if(!bounds) return -1;
+    split->bounds = bounds;
+    split->frames_cap = cap;
+    return 0;
+}
+
+// fix the idx of every child starting at *from
+static void renumber(split_t *split, size_t from){
+    for(size_t i = from; i < split->nframes; i++){
+        split->frames[i]->idx = i;
+    }
+}
+
+/* Insert a child at index i, which starts at bound.  The child before it
+   shrinks to make room.  Room must already be reserved. */
+static void insert_frame(split_t *split, size_t i, split_t *child,
+                         float bound){
+    split_touch(split);
+    size_t n = split->nframes;
+    memmove(&split->frames[i + 1], &split->frames[i],
+            sizeof(*split->frames) * (n - i));
+    memmove(&split->bounds[i + 1], &split->bounds[i],
+            sizeof(*split->bounds) * (n + 1 - i));
+    split->frames[i] = child;
+    split->bounds[i] = bound;
+    split->nframes++;
+    child->parent = split;
+    renumber(split, i);
+}
+
+/* Remove the child at index i.  Its neighbors split the space it leaves
+   behind, so the rest of the children keep their geometry. */
+static void remove_frame(split_t *split, size_t i){
+    split_touch(split);
+    size_t n = split->nframes;
+    float mid = (split->bounds[i] + split->bounds[i + 1]) / 2;
+    memmove(&split->frames[i], &split->frames[i + 1],
+            sizeof(*split->frames) * (n - i - 1));
+    memmove(&split->bounds[i + 1], &split->bounds[i + 2],
+            sizeof(*split->bounds) * (n - i - 1));
+    split->nframes--;
+    if(i == split->nframes){
+        // the last child was removed, the one before it grows to the end
+        split->bounds[i] = 1.0;
+    }else if(i > 0){
+        split->bounds[i] = mid;
+    }
+    renumber(split, i);
+}
+
+/* Replace a child split with its own children, which have the same
+   orientation as *split.  Returns 0 or -1. */
+static int splice_frames(split_t *split, split_t *child){
+    size_t i = child->idx;
+    size_t n = split->nframes;
+    size_t k = child->nframes;
+    if(reserve_frames(split, n - 1 + k)) return -1;
+    split_touch(split);
+    float lo = split->bounds[i];
+    float hi = split->bounds[i + 1];
+    // make room after the child
+    memmove(&split->frames[i + k], &split->frames[i + 1],
+            sizeof(*split->frames) * (n - i - 1));
+    memmove(&split->bounds[i + k], &split->bounds[i + 1],
+            sizeof(*split->bounds) * (n - i));
+    // fill in the grandchildren, scaled to the space of the child
+    for(size_t j = 0; j < k; j++){
+        split->frames[i + j] = child->frames[j];
+        child->frames[j]->parent = split;
+        if(j > 0) split->bounds[i + j] = lo + (hi - lo)*child->bounds[j];
+    }
+    split->nframes = n - 1 + k;
+    renumber(split, i);
+    // the child is empty now
+    child->nframes = 0;
+    child->parent = NULL;
+    free_node(child);
+    return 0;
+}
+
+/* first frame inherits any window or global focus, but redrawing that window
    has to be done at a higher level.  Same with uncovering a hidden window */
-int split_do_split(split_t *split, bool vertical, float fraction){
-    // allocate two children
-    split->frames[0] = split_new(split);
-    if(!split->frames[0]) return -1;
-    split->frames[1] = split_new(split);
-    if(!split->frames[1]){
-        split_free(split->frames[0]);
-        return -1;
+split_t *split_do_split(split_t *split, bool vertical, float fraction){
+    slab_t *slab = slab_of(split);
+    split_t *parent = split->parent;
+
+    if(parent && parent->isvertical == vertical){
+        /* the parent is already split this way, so *split just gives some of
+           its space to a new sibling and keeps its window and focus */
+        if(reserve_frames(parent, parent->nframes + 1)) return NULL;
+        split_t *new = split_new(slab, parent);
+        if(!new) return NULL;
+        new->screen = split->screen;
+        size_t i = split->idx;
+        float lo = parent->bounds[i];
+        float hi = parent->bounds[i + 1];
+        insert_frame(parent, i + 1, new, lo + (hi - lo)*fraction);
+        leaf_insert_after(split, new);
+        return new;
     }
+
+    // otherwise *split becomes the parent of two new children
+    if(reserve_frames(split, 2)) return NULL;
+    split_t *first = split_new(slab, split);
+    if(!first) return NULL;
+    split_t *second = split_new(slab, split);
+    if(!second){
+        split_free(first);
+        return NULL;
+    }
+    first->screen = split->screen;
+    second->screen = split->screen;
+    // the first child is the same frame as far as the user can tell
+    first->focused = split->focused;
+    first->id = split->id;
+    // so the id goes with it, and the new inner split gets its own
+    split->id = ++last_id;
+    split_touch(split);
     // set values
-    split->fraction = fraction;
+    split->frames[0] = first;
+    split->frames[1] = second;
+    split->bounds[0] = 0.0;
+    split->bounds[1] = fraction;
+    split->bounds[2] = 1.0;
+    split->nframes = 2;
+    renumber(split, 0);
     split->isvertical = vertical;
     split->isleaf = false;
+    // the children take the place of *split in the thread of leaves
+    leaf_replace(split, first);
+    leaf_insert_after(first, second);
     // if we have a win_info that needs to be passed to the child
     if(split->win_info){
         // move *win_info to child
-        split->frames[0]->win_info = split->win_info;
+        first->win_info = split->win_info;
         split->win_info = NULL;
         // fix *frame pointer in win_info
-        split->frames[0]->win_info->frame = split->frames[0];
+        first->win_info->frame = first;
     }
     // pass focus if necessary
     if(g_workspace->focus == split){
-        g_workspace->focus = split->frames[0];
+        g_workspace->focus = first;
     }
 
-    return 0;
+    return second;
 }
 
 /* Workspace should pre-check and not call this on a root frame.  The window in
    this frame should already have been hidden.  Redrawing and fixing focus has
-   to be done at a higher level.  The return value is the next frame
-   that would be focused on (though moving focus is not done here). */
+   to be done at a higher level. */
 split_t *split_do_remove(split_t *split){
     split_t *parent = split->parent;
-    split_t *other = parent->frames[split == parent->frames[0]];
-    // parent inherits all the goodness that was the other child frame
-    parent->frames[0] = other->frames[0];
-    parent->frames[1] = other->frames[1];
+    size_t i = split->idx;
+    remove_frame(parent, i);
+    split->parent = NULL;
+    split_free(split);
+    // the neighbor before the removed frame took its place (if there was one)
+    split_t *heir = parent->frames[i > 0 ? i - 1 : 0];
+
+    if(parent->nframes > 1) return heir;
+
+    // only one child is left, so the parent inherits all of its goodness
+    split_t *other = heir;
+    free(parent->frames);
+    free(parent->bounds);
+    parent->frames = other->frames;
+    parent->bounds = other->bounds;
+    parent->frames_cap = other->frames_cap;
+    parent->nframes = other->nframes;
     parent->isvertical = other->isvertical;
-    parent->fraction = other->fraction;
     parent->isleaf = other->isleaf;
     parent->win_info = other->win_info;
+    parent->screen = other->screen;
+    parent->focused = other->focused;
+    // a leaf stays the same frame in its new place; inner splits keep theirs
+    if(other->isleaf) parent->id = other->id;
     // fix backrefs that used to point to other child
     if(parent->win_info) parent->win_info->frame = parent;
-    if(parent->frames[0]) parent->frames[0]->parent = parent;
-    if(parent->frames[1]) parent->frames[1]->parent = parent;
+    if(parent->isleaf) leaf_replace(other, parent);
+    renumber(parent, 0);
+    for(size_t j = 0; j < parent->nframes; j++){
+        parent->frames[j]->parent = parent;
+    }
+    if(g_workspace->focus == other){
+        g_workspace->focus = parent;
+    }
     // now free the other child
-    other->frames[0] = NULL;
-    other->frames[1] = NULL;
-    split_free(other);
-    // now free fre frame we are removing
-    split_free(split);
-    // find the firstmost leaf of the parent frame
-    split_t *remains = parent;
-    while(!remains->isleaf) remains = remains->frames[0];
-    return remains;
+    other->frames = NULL;
+    other->bounds = NULL;
+    other->nframes = 0;
+    free_node(other);
+    heir = parent;
+
+    /* the parent may now have the same orientation as the grandparent, in
+       which case its children move up into the grandparent */
+    split_t *grandparent = parent->parent;
+    if(!parent->isleaf && grandparent
+            && grandparent->isvertical == parent->isvertical){
+        split_t *first = parent->frames[0];
+        // if we run out of memory, the tree is just deeper than necessary
+        if(splice_frames(grandparent, parent) == 0) heir = first;
+    }
+    return heir;
+}
+
+void split_collapse(split_t *split){
+    if(split->isleaf) return;
+    split_touch(split);
+    // *split takes the place of all of its leaves in the thread
+    split_t *first = split_first_leaf(split);
+    split_t *last = split_last_leaf(split);
+    split->prev_leaf = first->prev_leaf;
+    split->next_leaf = last->next_leaf;
+    if(split->prev_leaf) split->prev_leaf->next_leaf = split;
+    if(split->next_leaf) split->next_leaf->prev_leaf = split;
+    first->prev_leaf = NULL;
+    last->next_leaf = NULL;
+    split->screen = first->screen;
+    // free everything under *split
+    for(size_t i = 0; i < split->nframes; i++){
+        split->frames[i]->parent = NULL;
+        split_free(split->frames[i]);
+    }
+    split->nframes = 0;
+    split->isleaf = true;
+}
+
+split_t *split_do_only(split_t *split){
+    split_t *root = split;
+    while(root->parent) root = root->parent;
+    if(root == split) return root;
+    ws_win_info_t *win_info = split->win_info;
+    screen_t *screen = split->screen;
+    uint64_t focused = split->focused;
+    uint64_t id = split->id;
+    split->win_info = NULL;
+    // pass focus if necessary
+    if(g_workspace->focus == split){
+        g_workspace->focus = root;
+    }
+    split_collapse(root);
+    // the root inherits the window of *split
+    root->win_info = win_info;
+    if(root->win_info) root->win_info->frame = root;
+    root->screen = screen;
+    root->focused = focused;
+    root->id = id;
+    return root;
+}
+
+int split_build(split_t *split, snap_t *snap){
+    if(snap->isleaf || !split->isleaf) return 0;
+    size_t n = snap->nframes;
+    if(reserve_frames(split, n)) return -1;
+    slab_t *slab = slab_of(split);
+    for(size_t i = 0; i < n; i++){
+        split_t *kid = split_new(slab, split);
+        if(!kid){
+            for(size_t j = 0; j < i; j++) free_node(split->frames[j]);
+            return -1;
+        }
+        kid->screen = split->screen;
+        split->frames[i] = kid;
+    }
+    split_touch(split);
+    memcpy(split->bounds, snap->bounds, sizeof(*split->bounds) * (n + 1));
+    split->nframes = n;
+    renumber(split, 0);
+    split->isvertical = snap->isvertical;
+    split->isleaf = false;
+    // the new leaves take the place of *split in the thread of leaves
+    leaf_replace(split, split->frames[0]);
+    for(size_t i = 1; i < n; i++){
+        leaf_insert_after(split->frames[i - 1], split->frames[i]);
+    }
+    // keep going, even if some subtree runs out of memory
+    int ret = 0;
+    for(size_t i = 0; i < n; i++){
+        if(split_build(split->frames[i], snap->frames[i])) ret = -1;
+    }
+    return ret;
+}
+
+/* Cut *split into n equal pieces, writing the leaf of each piece to out[].
+   Returns how many pieces there are, which is less than n if we ran out of
+   memory. */
+static size_t split_evenly(split_t *split, bool vertical, size_t n,
+                           split_t **out){
+    size_t count = 1;
+    out[0] = split;
+    for(; count < n; count++){
+        // the last piece keeps 1/(what's left) and gives away the rest
+        split_t *new = split_do_split(out[count - 1], vertical,
+                                      1.0f / (float)(n - count + 1));
+        if(!new) break;
+        out[count - 1] = new->parent->frames[new->idx - 1];
+        out[count] = new;
+    }
+    return count;
+}
+
+size_t split_do_grid(split_t *split, size_t n, split_t **last){
+    *last = split;
+    if(n < 2) return 1;
+    // as square as possible, with rows of the same orientation as the parent
+    size_t cols = 1;
+    while(cols * cols < n) cols++;
+    size_t rows = (n + cols - 1) / cols;
+    bool vertical = split->parent ? !split->parent->isvertical : true;
+
+    // room for the leaf of every row, then the leaves of one row
+    split_t **pieces = malloc(sizeof(*pieces) * (rows + cols));
+    if(!pieces) return 1;
+    split_t **cells = &pieces[rows];
+    rows = split_evenly(split, vertical, rows, pieces);
+
+    // each row gets its share of the cells, the first rows get any extras
+    size_t total = 0;
+    for(size_t i = 0; i < rows; i++){
+        size_t ncells = n / rows + (i < n % rows);
+        if(ncells > cols) ncells = cols;
+        size_t got = split_evenly(pieces[i], !vertical, ncells, cells);
+        total += got;
+        *last = cells[got - 1];
+    }
+    free(pieces);
+    return total;
+}
+
+split_t *split_first_leaf(split_t *split){
+    while(!split->isleaf) split = split->frames[0];
+    return split;
+}
+
+split_t *split_last_leaf(split_t *split){
+    while(!split->isleaf) split = split->frames[split->nframes - 1];
+    return split;
+}
+
+void split_join_leaves(split_t *prev_root, split_t *root){
+    split_t *last = split_last_leaf(prev_root);
+    split_t *first = split_first_leaf(root);
+    last->next_leaf = first;
+    first->prev_leaf = last;
+}
+
+// no frame can be resized smaller than this fraction of its parent
+#define MIN_FRACTION 0.05f
+
+float split_set_bound(split_t *split, size_t i, float pos){
+    if(i == 0 || i >= split->nframes) return split->bounds[i];
+    float lo = split->bounds[i - 1] + MIN_FRACTION;
+    float hi = split->bounds[i + 1] - MIN_FRACTION;
+    if(lo > hi) return split->bounds[i];
+    split_touch(split);
+    split->bounds[i] = pos < lo ? lo : (pos > hi ? hi : pos);
+    return split->bounds[i];
+}
+
+split_t *split_do_resize(split_t *split, bool vertical, float delta){
+    // find the frame which is laid out along this axis
+    while(split->parent && split->parent->isvertical != vertical){
+        split = split->parent;
+    }
+    split_t *parent = split->parent;
+    if(!parent) return NULL;
+    size_t i = split->idx;
+    // the far edge moves, or the near edge for the last frame
+    size_t edge = i + 1 < parent->nframes ? i + 1 : i;
+    float old = parent->bounds[edge];
+    float new = split_set_bound(parent, edge, old + delta);
+    return new == old ? NULL : parent;
 }
 
 sides_t get_sides(split_t *split){
     // fractions of the view so far
     float t = 0.0, b = 1.0, l = 0.0, r = 1.0;
     for(split_t *cur = split; cur->parent; cur = cur->parent){
-        // which child are we?
-        int idx = (cur->parent->frames[1] == cur);
-        // parent's fraction
-        float pfrac = cur->parent->fraction;
+        // our span within the parent
+        float lo = cur->parent->bounds[cur->idx];
+        float hi = cur->parent->bounds[cur->idx + 1];
         if(cur->parent->isvertical){
             // vertical split
-            if(idx == 0){
-                // first child
-                t *= pfrac;
-                b *= pfrac;
-            }else{
-                t = pfrac + (1-pfrac)*t;
-                b = pfrac + (1-pfrac)*b;
-            }
+            t = lo + (hi - lo)*t;
+            b = lo + (hi - lo)*b;
         }else{
             // horizontal split
-            if(idx == 0){
-                // first child
-                l *= pfrac;
-                r *= pfrac;
-            }else{
-                l = pfrac + (1-pfrac)*l;
-                r = pfrac + (1-pfrac)*r;
-            }
+            l = lo + (hi - lo)*l;
+            r = lo + (hi - lo)*r;
         }
     }
     return (sides_t){.t = t, .b = b, .l = l, .r = r};
 }
 
+// find the child containing pos, ties go to the first child
+static size_t frame_at(split_t *split, float pos){
+    // binary search for the first child which ends at or after pos
+    size_t lo = 0, hi = split->nframes - 1;
+    while(lo < hi){
+        size_t mid = (lo + hi) / 2;
+        if(pos <= split->bounds[mid + 1]){
+            hi = mid;
+        }else{
+            lo = mid + 1;
+        }
+    }
+    return lo;
+}
+
 split_t *do_split_move(split_t *start, bool vertical, bool increasing){
     /* pos is the centerpoint of the starting frame on the border-to-cross
        relative to our current position */
@@ -132,79 +587,118 @@ split_t *do_split_move(split_t *start, bool vertical, bool increasing){
         split_t *parent = here->parent;
         if(!parent){
             // found root split
-            // TODO: handle multiple screens
+            // (crossing between screens is done with the workspace leafindex)
             return start;
         }
-        bool first_child = (parent->frames[0] == here);
+        size_t i = here->idx;
         if(parent->isvertical != vertical){
             // split is the wrong way, recalculate pos
-            if(first_child){
-                pos *= parent->fraction;
-            }else{
-                pos = parent->fraction + (1-parent->fraction)*pos;
-            }
-        }else if(first_child == increasing){
+            float lo = parent->bounds[i];
+            float hi = parent->bounds[i + 1];
+            pos = lo + (hi - lo)*pos;
+        }else if(increasing && i + 1 < parent->nframes){
             // we found the split we need to cross
-            here = here->parent;
+            here = parent->frames[i + 1];
+            break;
+        }else if(!increasing && i > 0){
+            here = parent->frames[i - 1];
             break;
         }else{
             // split is the right way, but we are on the wrong side of it
             // (continue up tree, nothing to do here)
         }
-        here = here->parent;
+        here = parent;
     }
-    /* now *here points to the parent of the split we want to cross.  First,
-       just cross that split. */
-    here = here->frames[increasing];
 
     // Now descend to the appropriate leaf.
     while(!here->isleaf){
         if(here->isvertical == vertical){
             // easy case, no need to recalculate pos
             // if we are increasing, take the first child
-            // (if we are going *right*, take the *left* child)
-            // ((damn this is confusing))
-            here = here->frames[increasing == 0];
+            // (if we are going *right*, take the *left*most child)
+            here = here->frames[increasing ? 0 : here->nframes - 1];
         }else{
-            // ties go to first child
-            if(pos <= here->fraction){
-                // take the first child
-                pos = pos / here->fraction;
-                here = here->frames[0];
-            }else{
-                // take the second child
-                pos = (pos - here->fraction) / (1 - here->fraction);
-                here = here->frames[1];
-            }
+            size_t i = frame_at(here, pos);
+            float lo = here->bounds[i];
+            float hi = here->bounds[i + 1];
+            pos = (pos - lo) / (hi - lo);
+            here = here->frames[i];
         }
     }
     // done! *here points to where we want to be
     return here;
 }
 
-static int do_at_each(split_t *split, split_do_cb_t cb, void* data,
-                      float t, float b, float l, float r){
-    int ret = 0;
-    ret = cb(split, data, t, b, l, r);
-    if(ret) return ret;
-    // don't descend past a leaf
-    if(split->isleaf) return 0;
-    if(split->isvertical){
-        float line = t + (b-t)*split->fraction;
-        ret = do_at_each(split->frames[0], cb, data, t, line, l, r);
-        if(ret) return ret;
-        ret = do_at_each(split->frames[1], cb, data, line, b, l, r);
-        if(ret) return ret;
-    }else{
-        float line = l + (r-l)*split->fraction;
-        ret = do_at_each(split->frames[0], cb, data, t, b, l, line);
-        if(ret) return ret;
-        ret = do_at_each(split->frames[1], cb, data, t, b, line, r);
-        if(ret) return ret;
+typedef struct {
+    split_t *split;
+    float t;
+    float b;
+    float l;
+    float r;
+} walk_item_t;
+
+// deep enough for any tree a person would build by hand
+#define WALK_STACK_INLINE 64
+
+int split_walk(split_t *split, split_walk_cb_t cb, void *data, int flags){
+    int retval = 0;
+    // the stack lives on the C stack unless the tree is very deep
+    walk_item_t inline_stack[WALK_STACK_INLINE];
+    walk_item_t *stack = inline_stack;
+    size_t cap = WALK_STACK_INLINE;
+    size_t n = 0;
+
+    sides_t sides = get_sides(split);
+    stack[n++] = (walk_item_t){split, sides.t, sides.b, sides.l, sides.r};
+
+    while(n){
+        walk_item_t it = stack[--n];
+        split = it.split;
+        if(split->isleaf || !(flags & SPLIT_WALK_LEAVES_ONLY)){
+            split_walk_t ret = cb(split, data, it.t, it.b, it.l, it.r);
+            if(ret == SPLIT_WALK_STOP){
+                retval = 1;
+                break;
+            }
+            if(ret == SPLIT_WALK_PRUNE) continue;
+        }
+        // don't descend past a leaf
+        if(split->isleaf) continue;
+        // make room for all the children
+        if(n + split->nframes > cap){
+            size_t newcap = cap;
+            while(n + split->nframes > newcap) newcap *= 2;
+            walk_item_t *temp;
+            if(stack == inline_stack){
+                temp = malloc(sizeof(*stack) * newcap);
+                if(temp) memcpy(temp, stack, sizeof(*stack) * n);
+            }else{
+                temp = realloc(stack, sizeof(*stack) * newcap);
+            }
+            if(!temp){
+                retval = -1;
+                break;
+            }
+            stack = temp;
+            cap = newcap;
+        }
+        // push the children backwards, so the first child is visited first
+        for(size_t i = split->nframes; i-- > 0;){
+            float lo = split->bounds[i];
+            float hi = split->bounds[i + 1];
+            walk_item_t kid = it;
+            kid.split = split->frames[i];
+            if(split->isvertical){
+                kid.t = it.t + (it.b - it.t)*lo;
+                kid.b = it.t + (it.b - it.t)*hi;
+            }else{
+                kid.l = it.l + (it.r - it.l)*lo;
+                kid.r = it.l + (it.r - it.l)*hi;
+            }
+            stack[n++] = kid;
+        }
     }
-    return 0;
-}
 
-int split_do_at_each(split_t *split, split_do_cb_t cb, void* data){
-    return do_at_each(split, cb, data, 0.0, 1.0, 0.0, 1.0);
+    if(stack != inline_stack) free(stack);
+    return retval;
 }
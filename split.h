@@ -10,8 +10,41 @@ static inline int frac_of(float f, int size){
     return (int)roundf(f * (size-1));
 }
 
-// use parent=NULL for a root element
-split_t *split_new(split_t *parent);
+// allocator stats for split_t
+extern slab_type_t split_slab_type;
+
+/* A snap_t is a read-only copy of a split tree, for the layout history.
+   Snapshots are persistent: split_snapshot() reuses the last snapshot of any
+   subtree which hasn't changed since, so a series of snapshots only costs the
+   nodes that actually changed between them.  Every change to a split has to
+   call split_touch(), which split.c does for its own operations. */
+typedef struct snap_t {
+    int refs;
+    bool isleaf;
+    bool isvertical;
+    /* the handle of the window in a leaf, or 0.  The window might not exist
+       anymore, and its window_t may belong to another window by now, so it
+       has to be looked up with winhandle_get(). */
+    uint64_t window;
+    // children, and their bounds like in split_t
+    size_t nframes;
+    float *bounds;
+    struct snap_t *frames[];
+} snap_t;
+
+// returns a new reference to a snapshot of the subtree, or NULL for error
+snap_t *split_snapshot(split_t *split);
+/* for building a snapshot by hand: room for n frames (and n+1 bounds), with
+   nframes=0 and one reference.  Everything else is left to the caller. */
+snap_t *snap_new(size_t n);
+void snap_unref(snap_t *snap);
+// forget the snapshot of a split and all of its parents
+void split_touch(split_t *split);
+// do two snapshots describe the same layout?
+bool snap_equal(snap_t *a, snap_t *b);
+
+// allocates from *slab; use parent=NULL for a root element
+split_t *split_new(slab_t *slab, split_t *parent);
 // frees all the split_t objects, closing windows that are left
 void split_free(split_t *split);
 
@@ -26,20 +59,72 @@ typedef struct {
    screen area) for a given split. */
 sides_t get_sides(split_t *split);
 
-// returns 0 for OK or -1 for error
-/* first child inherits any window or global focus, but redrawing that window
-   has to be done at a higher level.  Same with uncovering a hidden window */
-int split_do_split(split_t *split, bool vertical, float fraction);
+/* Returns the new, empty frame, or NULL for error.  The new frame is always
+   right after the frame which keeps the old window (the old frame itself, if
+   it was merged into a parent split the same way, or else its new first
+   child).  That frame inherits any window or global focus, but redrawing that
+   window has to be done at a higher level.  Same with uncovering a hidden
+   window */
+split_t *split_do_split(split_t *split, bool vertical, float fraction);
 
 /* Workspace should pre-check and not call this on a root frame.  The window in
    this frame should already have been hidden.  Redrawing and fixing focus has
-   to be done at a higher level.  The return value is the next frame
-   that would be focused on (though moving focus is not done here). */
+   to be done at a higher level.  The return value is the split which took over
+   the space of the removed frame; every leaf which changed shape is under the
+   return value's parent (or under the return value, if it is a root).  Its
+   first leaf would be the next frame to focus on (though moving focus is not
+   done here). */
 split_t *split_do_remove(split_t *split);
 
+/* Collapse the whole tree containing *split into a single frame, which is
+   returned (the root).  The root inherits the window of *split, and the global
+   focus if *split had it.  Any other windows in the tree should already have
+   been hidden.  Redrawing has to be done at a higher level. */
+split_t *split_do_only(split_t *split);
+
+/* Make *split a leaf, freeing everything under it.  Any windows under it
+   should already have been hidden.  Redrawing has to be done at a higher
+   level. */
+void split_collapse(split_t *split);
+
+/* Grow an empty leaf into the shape of a snapshot, without any windows.
+   Returns 0, or -1 if some part of the snapshot couldn't be built. */
+int split_build(split_t *split, snap_t *snap);
+
+/* Cut a leaf into a grid of n frames, as close to square as possible.  The
+   frames run from split_first_leaf(split) to *last in the thread of leaves,
+   and the first one inherits any window or global focus.  Returns how many
+   frames were made, which might be less than n if we ran out of memory.
+   Redrawing has to be done at a higher level. */
+size_t split_do_grid(split_t *split, size_t n, split_t **last);
+
+/* Leaves are threaded together in screen order through prev_leaf and
+   next_leaf.  split_do_split and split_do_remove keep the thread intact, and
+   split_free cuts the freed leaves out of it, so stepping to the next or
+   previous frame never needs a traversal. */
+
+// the top-left leaf under a split
+split_t *split_first_leaf(split_t *split);
+// the bottom-right leaf under a split
+split_t *split_last_leaf(split_t *split);
+// thread the leaves of *root right after the leaves of *prev_root
+void split_join_leaves(split_t *prev_root, split_t *root);
+
 // call window_map on a single frame, *split must be a leaf
 void split_map_window(split_t *split, ws_win_info_t *win_info);
 
+/* Move the boundary before frames[i] of *split to pos (a fraction of the
+   split), but never make a frame too small.  Returns where the boundary ended
+   up.  Redrawing has to be done at a higher level. */
+float split_set_bound(split_t *split, size_t i, float pos);
+
+/* Move a border of a frame along one axis, by delta as a fraction of the
+   split which has to change: a positive delta moves it right or down, a
+   negative one left or up.  The border is the frame's far edge, or its near
+   edge if it is the last frame in the split.  Returns that split, or NULL if
+   nothing changed.  Redrawing has to be done at a higher level. */
+split_t *split_do_resize(split_t *split, bool vertical, float delta);
+
 // never returns NULL; if no move possible, returns *start
 split_t *do_split_move(split_t *start, bool vertical, bool increasing);
 
@@ -56,10 +141,28 @@ static inline split_t *split_move_down(split_t *start){
     return do_split_move(start, true, true);
 }
 
-// get a callback at every leaf of the split tree, with relative boundaries
-typedef int (*split_do_cb_t)(split_t *split, void* data,
-                             float t, float b, float l, float r);
+// returned by a split_walk_cb_t
+typedef enum {
+    SPLIT_WALK_CONTINUE = 0,
+    // don't visit the children of this split
+    SPLIT_WALK_PRUNE,
+    // end the whole walk now
+    SPLIT_WALK_STOP,
+} split_walk_t;
+
+// flags for split_walk
+enum {
+    // only call the callback on leaves
+    SPLIT_WALK_LEAVES_ONLY = 1 << 0,
+};
+
+// a callback for each split in a tree, with boundaries relative to its root
+typedef split_walk_t (*split_walk_cb_t)(split_t *split, void* data,
+                                        float t, float b, float l, float r);
 
-int split_do_at_each(split_t *split, split_do_cb_t cb, void* data);
+/* Walk the subtree under *split in depth-first order, parents first.  The walk
+   is not recursive, so any depth of tree is OK.  Returns 0 if the walk
+   finished, 1 if a callback stopped it, or -1 for a memory error. */
+int split_walk(split_t *split, split_walk_cb_t cb, void *data, int flags);
 
 #endif // SPLIT_H
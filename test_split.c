@@ -19,22 +19,32 @@ size_t g_nworkspaces;
 void draw_split(char grid[HEIGHT][WIDTH+1], split_t *split,
                 float t, float b, float l, float r){
     if(split->isleaf) return;
-    if(split->isvertical){
-        float line = t + (b-t)*split->fraction;
-        int idx = frac_of(line, HEIGHT);
-        for(int i = frac_of(l, WIDTH) + 1; i < frac_of(r, WIDTH); i++){
-            grid[idx][i] = '-';
+    for(size_t i = 0; i < split->nframes; i++){
+        float lo = split->bounds[i];
+        float hi = split->bounds[i + 1];
+        if(split->isvertical){
+            float start = t + (b-t)*lo;
+            float end = t + (b-t)*hi;
+            if(i > 0){
+                int idx = frac_of(start, HEIGHT);
+                int end_col = frac_of(r, WIDTH);
+                for(int j = frac_of(l, WIDTH) + 1; j < end_col; j++){
+                    grid[idx][j] = '-';
+                }
+            }
+            draw_split(grid, split->frames[i], start, end, l, r);
+        }else{
+            float start = l + (r-l)*lo;
+            float end = l + (r-l)*hi;
+            if(i > 0){
+                int idx = frac_of(start, WIDTH);
+                int end_row = frac_of(b, HEIGHT);
+                for(int j = frac_of(t, HEIGHT) + 1; j < end_row; j++){
+                    grid[j][idx] = '|';
+                }
+            }
+            draw_split(grid, split->frames[i], t, b, start, end);
         }
-        draw_split(grid, split->frames[0], t, line, l, r);
-        draw_split(grid, split->frames[1], line, b, l, r);
-    }else{
-        float line = l + (r-l)*split->fraction;
-        int idx = frac_of(line, WIDTH);
-        for(int i = frac_of(t, HEIGHT) + 1; i < frac_of(b, HEIGHT); i++){
-            grid[i][idx] = '|';
-        }
-        draw_split(grid, split->frames[0], t, b, l, line);
-        draw_split(grid, split->frames[1], t, b, line, r);
     }
 }
 
@@ -117,11 +127,14 @@ void draw_layout(split_t *root, split_t *highlight){
     write(1, &grid, HEIGHT*(WIDTH+1));
 }
 
-#define vsplit(split, fraction) split_do_split(split, true, fraction)
-#define hsplit(split, fraction) split_do_split(split, false, fraction)
+// these return true on error
+#define vsplit(split, fraction) (split_do_split(split, true, fraction) == NULL)
+#define hsplit(split, fraction) (split_do_split(split, false, fraction) == NULL)
 
 int main(){
-    split_t *root = split_new(NULL);
+    slab_t slab;
+    slab_init(&slab, &split_slab_type);
+    split_t *root = split_new(&slab, NULL);
     split_t *highlight = NULL;
     if(!root) return 1;
     if(hsplit(root, .5)) goto fail;
@@ -145,9 +158,11 @@ int main(){
 
     draw_layout(root, highlight);
     split_free(root);
+    slab_deinit(&slab);
     return 0;
 
 fail:
     split_free(root);
+    slab_deinit(&slab);
     return 1;
 }
@@ -16,6 +16,11 @@
 #include "workspace.h"
 #include "bindings.h"
 #include "libvenowm.h"
+#include "layoutfile.h"
+#include "winsearch.h"
+#include "rules.h"
+#include "launch.h"
+#include "winhandle.h"
 
 // backend_t, needed for keybindings
 static backend_t *be;
@@ -61,31 +66,28 @@ int compositor_main(){
         return 99;
     }
 
-    INIT_PTR(g_workspaces, g_workspaces_size, g_nworkspaces, 8, err);
-    if(err){
+    // how long before a client which doesn't answer pings is hung
+    const char *ping_timeout = getenv("VENOWM_PING_TIMEOUT_MS");
+    // whether to kill hung windows which won't close
+    const char *kill_hung = getenv("VENOWM_KILL_HUNG");
+    be_set_hung_policy(be, ping_timeout ? (uint32_t)atoi(ping_timeout) : 0,
+                       kill_hung && strcmp(kill_hung, "0") != 0);
+    // how much texture memory hidden windows may keep, in megabytes
+    const char *budget = getenv("VENOWM_TEXTURE_BUDGET_MB");
+    if(budget) be_set_texture_budget(be, (size_t)atol(budget) << 20);
+
+    if(workspaces_init(be)){
         retval = 99;
         goto cu_backend;
     }
 
-    // allocate some workspaces
-    for(size_t i = 0; i <= 5; i ++){
-        workspace_t *new = workspace_new(be);
-        if(!new){
-            retval = 99;
-            goto cu_workspaces;
-        }
-        int err;
-        APPEND_PTR(g_workspaces, g_workspaces_size, g_nworkspaces, new, err);
-        if(err){
-            workspace_free(new);
-            retval = 99;
-            goto cu_workspaces;
-        }
+    // other workspaces are made as they are needed
+    g_workspace = workspace_get("1");
+    if(!g_workspace){
+        retval = 99;
+        goto cu_workspaces;
     }
 
-    // set first workspace
-    g_workspace = g_workspaces[0];
-
     INIT_PTR(g_screens, g_screens_size, g_nscreens, 4, err);
     if(err){
         retval = 99;
@@ -94,19 +96,35 @@ int compositor_main(){
 
     if(add_bindings(be)) goto cu_workspaces;
 
+    if(layoutfile_init(be)){
+        retval = 99;
+        goto cu_workspaces;
+    }
+    // the saved layout has to be ready before the first screen shows up
+    if(layoutfile_load()){
+        logmsg("unable to load the saved layout\n");
+    }
+    if(rules_load()){
+        logmsg("unable to load the placement rules\n");
+    }
+
     backend_run(be);
 
     logmsg("post run\n");
 
+    // the screens are still around, so the last changes can be saved
+    layoutfile_free();
+
 //cu_screens:
     // screens are freed by the pre-destroy-screen handler
     FREE_PTR(g_screens, g_screens_size, g_nscreens);
 cu_workspaces:
     // but we have to manually free workspaces
-    for(size_t i = 0; i < g_nworkspaces; i++){
-        workspace_free(g_workspaces[i]);
-    }
-    FREE_PTR(g_workspaces, g_workspaces_size, g_nworkspaces);
+    workspaces_free();
+    winsearch_free();
+    rules_free();
+    launch_free();
+    winhandle_free();
 cu_backend:
     backend_free(be);
     logmsg("exiting from main: %d\n", retval);
@@ -164,6 +182,261 @@ int launch_main(int argc, char **argv){
     return 0;
 }
 
+int resize_main(const char *dx, const char *dy){
+    char *end;
+    double x = strtod(dx, &end);
+    if(*end != '\0'){
+        fprintf(stderr, "bad resize amount: %s\n", dx);
+        return 1;
+    }
+    double y = strtod(dy, &end);
+    if(*end != '\0'){
+        fprintf(stderr, "bad resize amount: %s\n", dy);
+        return 1;
+    }
+
+    struct venowm *v = venowm_create();
+    if(!v){
+        fprintf(stderr, "failed to create venowm client\n");
+        return 1;
+    }
+
+    int ret = venowm_connect(v, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    ret = venowm_resize(v, x, y, true);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    venowm_destroy(v);
+
+    return 0;
+}
+
+// for commands which take one string, like workspace NAME
+int string_command_main(int (*func)(struct venowm*, const char*, bool),
+                        const char *arg){
+    struct venowm *v = venowm_create();
+    if(!v){
+        fprintf(stderr, "failed to create venowm client\n");
+        return 1;
+    }
+
+    int ret = venowm_connect(v, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    ret = func(v, arg, true);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    venowm_destroy(v);
+
+    return 0;
+}
+
+static void print_alloc_stats(void *data, const char *name, uint32_t size,
+        uint32_t live, uint32_t peak){
+    (void)data;
+    printf("%-16s %8u %8u %8u\n", name, size, live, peak);
+}
+
+int alloc_stats_main(void){
+    struct venowm *v = venowm_create();
+    if(!v){
+        fprintf(stderr, "failed to create venowm client\n");
+        return 1;
+    }
+
+    int ret = venowm_connect(v, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    printf("%-16s %8s %8s %8s\n", "type", "size", "live", "peak");
+    ret = venowm_alloc_stats(v, print_alloc_stats, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    venowm_destroy(v);
+
+    return 0;
+}
+
+typedef struct {
+    struct venowm_client_stats stats;
+    char app_id[32];
+} client_row_t;
+
+typedef struct {
+    client_row_t *rows;
+    size_t num;
+    size_t size;
+    bool failed;
+} client_rows_t;
+
+static void add_client_row(void *data,
+        const struct venowm_client_stats *stats){
+    client_rows_t *rows = data;
+    if(rows->failed) return;
+    if(rows->num == rows->size){
+        size_t size = rows->size ? rows->size * 2 : 16;
+        client_row_t *new = realloc(rows->rows, size * sizeof(*new));
+        if(!new){
+            rows->failed = true;
+            return;
+        }
+        rows->rows = new;
+        rows->size = size;
+    }
+    client_row_t *row = &rows->rows[rows->num++];
+    row->stats = *stats;
+    // the string is only good during the callback
+    snprintf(row->app_id, sizeof(row->app_id), "%s", stats->app_id);
+    row->stats.app_id = row->app_id;
+}
+
+// the busiest clients first
+static int cmp_client_row(const void *a, const void *b){
+    const struct venowm_client_stats *x = &((const client_row_t*)a)->stats;
+    const struct venowm_client_stats *y = &((const client_row_t*)b)->stats;
+    if(x->commits_per_sec != y->commits_per_sec){
+        return x->commits_per_sec < y->commits_per_sec ? 1 : -1;
+    }
+    return (x->buffer_kb < y->buffer_kb) - (x->buffer_kb > y->buffer_kb);
+}
+
+int clients_main(void){
+    struct venowm *v = venowm_create();
+    if(!v){
+        fprintf(stderr, "failed to create venowm client\n");
+        return 1;
+    }
+
+    int ret = venowm_connect(v, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    client_rows_t rows = {0};
+    ret = venowm_client_stats(v, add_client_row, &rows);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        free(rows.rows);
+        return 1;
+    }
+    if(rows.failed){
+        fprintf(stderr, "out of memory\n");
+        free(rows.rows);
+        return 1;
+    }
+
+    qsort(rows.rows, rows.num, sizeof(*rows.rows), cmp_client_row);
+    printf("%7s %-20s %5s %9s %8s %7s %9s %9s\n", "pid", "app_id", "surfs",
+           "buf_kb", "commit/s", "frame/s", "cfg_avg", "cfg_max");
+    for(size_t i = 0; i < rows.num; i++){
+        const struct venowm_client_stats *c = &rows.rows[i].stats;
+        printf("%7u %-20s %5u %9u %8u %7u %7uus %7uus\n", c->pid,
+               c->app_id, c->surfaces, c->buffer_kb, c->commits_per_sec,
+               c->frames_per_sec, c->configure_avg_us, c->configure_max_us);
+    }
+    free(rows.rows);
+
+    venowm_destroy(v);
+
+    return 0;
+}
+
+static void print_search_result(void *data, uint64_t id,
+        const char *workspace, const char *app_id, const char *title,
+        uint32_t score){
+    (void)data;
+    printf("%016llx %-8s %4u %-20s %s\n", (unsigned long long)id, workspace,
+           score, app_id, title);
+}
+
+int search_main(const char *query){
+    struct venowm *v = venowm_create();
+    if(!v){
+        fprintf(stderr, "failed to create venowm client\n");
+        return 1;
+    }
+
+    int ret = venowm_connect(v, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    ret = venowm_search_windows(v, query, 20, print_search_result, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    venowm_destroy(v);
+
+    return 0;
+}
+
+// venowm window ID ACTION [ARG], where the ID comes from venowm search
+int window_main(int argc, char **argv){
+    char *end;
+    unsigned long long id = strtoull(argv[0], &end, 16);
+    if(!*argv[0] || *end){
+        fprintf(stderr, "bad window id: %s\n", argv[0]);
+        return 1;
+    }
+
+    struct venowm *v = venowm_create();
+    if(!v){
+        fprintf(stderr, "failed to create venowm client\n");
+        return 1;
+    }
+
+    int ret = venowm_connect(v, NULL);
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    const char *action = argv[1];
+    if(argc == 2 && strcmp(action, "focus") == 0){
+        ret = venowm_focus_window(v, id, true);
+    }else if(argc == 2 && strcmp(action, "close") == 0){
+        ret = venowm_close_window(v, id, true);
+    }else if(argc == 3 && strcmp(action, "to-workspace") == 0){
+        ret = venowm_window_to_workspace(v, id, argv[2], true);
+    }else if(argc == 3 && strcmp(action, "to-frame") == 0){
+        ret = venowm_window_to_frame(v, id, (uint32_t)atoi(argv[2]), true);
+    }else{
+        fprintf(stderr, "unknown window action: %s\n", action);
+        venowm_destroy(v);
+        return 1;
+    }
+    if(ret < 0){
+        fprintf(stderr, "%s\n", venowm_errmsg(v));
+        return 1;
+    }
+
+    venowm_destroy(v);
+
+    return 0;
+}
+
 int main(int argc, char **argv){
     if(argc < 2){
         return compositor_main();
@@ -180,18 +453,113 @@ int main(int argc, char **argv){
     if(strcmp(argv[1], "focus-right") == 0){
         return command_main(venowm_focus_right);
     }
+    if(strcmp(argv[1], "focus-next") == 0){
+        return command_main(venowm_focus_next);
+    }
+    if(strcmp(argv[1], "focus-prev") == 0){
+        return command_main(venowm_focus_prev);
+    }
+    if(strcmp(argv[1], "only") == 0){
+        return command_main(venowm_only);
+    }
+    if(strcmp(argv[1], "tile-hidden") == 0){
+        return command_main(venowm_tile_hidden);
+    }
+    if(strcmp(argv[1], "undo") == 0){
+        return command_main(venowm_undo);
+    }
+    if(strcmp(argv[1], "redo") == 0){
+        return command_main(venowm_redo);
+    }
+    if(strcmp(argv[1], "save-layout") == 0){
+        return command_main(venowm_save_layout);
+    }
+    if(strcmp(argv[1], "workspace") == 0){
+        if(argc == 3){
+            return string_command_main(venowm_switch_workspace, argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "bring-app") == 0){
+        if(argc == 3){
+            return string_command_main(venowm_bring_app_id, argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "bring-title") == 0){
+        if(argc == 3){
+            return string_command_main(venowm_bring_title, argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "search") == 0){
+        if(argc == 3){
+            return search_main(argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "goto") == 0){
+        if(argc == 3){
+            return string_command_main(venowm_goto_window, argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "window") == 0){
+        if(argc == 4 || argc == 5){
+            return window_main(argc - 2, &argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "move-to") == 0){
+        if(argc == 3){
+            return string_command_main(venowm_move_to_workspace, argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "copy-to") == 0){
+        if(argc == 3){
+            return string_command_main(venowm_copy_to_workspace, argv[2]);
+        }
+    }
+    if(strcmp(argv[1], "last-window") == 0){
+        return command_main(venowm_last_window);
+    }
+    if(strcmp(argv[1], "resize") == 0){
+        if(argc == 4){
+            return resize_main(argv[2], argv[3]);
+        }
+    }
     if(strcmp(argv[1], "launch") == 0){
         if(argc > 2){
             return launch_main(argc - 2, &argv[2]);
         }
     }
+    if(strcmp(argv[1], "alloc-stats") == 0){
+        return alloc_stats_main();
+    }
+    if(strcmp(argv[1], "clients") == 0){
+        return clients_main();
+    }
     fprintf(stderr,
         "usage: venowm\n"
         "usage: venowm focus_up\n"
         "usage: venowm focus_down\n"
         "usage: venowm focus_left\n"
         "usage: venowm focus_right\n"
+        "usage: venowm focus-next\n"
+        "usage: venowm focus-prev\n"
+        "usage: venowm only\n"
+        "usage: venowm tile-hidden\n"
+        "usage: venowm undo\n"
+        "usage: venowm redo\n"
+        "usage: venowm save-layout\n"
+        "usage: venowm workspace NAME\n"
+        "usage: venowm bring-app APP_ID\n"
+        "usage: venowm bring-title TITLE\n"
+        "usage: venowm search TEXT\n"
+        "usage: venowm goto TEXT\n"
+        "usage: venowm last-window\n"
+        "usage: venowm move-to WORKSPACE\n"
+        "usage: venowm copy-to WORKSPACE\n"
+        "usage: venowm window ID focus|close\n"
+        "usage: venowm window ID to-workspace NAME|to-frame N\n"
+        "usage: venowm resize DX DY\n"
         "usage: venowm launch ...\n"
+        "usage: venowm alloc-stats\n"
+        "usage: venowm clients\n"
     );
     return 1;
 }
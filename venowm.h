@@ -7,6 +7,7 @@
 
 #include "backend.h"
 #include "khash.h"
+#include "slab.h"
 
 #include "logmsg.h"
 
@@ -17,8 +18,18 @@ typedef struct {
     // more data to come at a later time
 } screen_t;
 
+// forward declaration of the special workspace hashtable
+struct ws_win_info_t;
+typedef struct ws_win_info_t ws_win_info_t;
+
 typedef struct {
     int refs; // how many workspaces is this window in?
+    // the ws_win_info_t of each of those workspaces (see window_members())
+    ws_win_info_t *members;
+    // this window's entry in the search index (see winsearch.h)
+    struct winsearch_entry_t *search;
+    // how clients name this window, or 0 (see winhandle.h)
+    uint64_t handle;
     be_window_t *be_window;
     // windows may close or die while there are still open refs to this struct
     bool isvalid;
@@ -28,10 +39,6 @@ typedef struct {
     backend_t *be;
 } window_t;
 
-// forward declaration of the special workspace hashtable
-struct ws_win_info_t;
-typedef struct ws_win_info_t ws_win_info_t;
-
 
 // define our custom hash table type for "workspace window list" data
 // name=wswl
@@ -51,14 +58,78 @@ typedef struct ws_win_info_t ws_win_info_t;
 KHASH_INIT(wswl, window_t*, ws_win_info_t*, true,
            ptr_hash_func, ptr_equal_func);
 
+// an on-screen rectangle in global coordinates, covering [l,r) x [t,b)
+typedef struct {
+    int32_t t;
+    int32_t b;
+    int32_t l;
+    int32_t r;
+} rect_t;
+
+// forward declarations for the winindex (see winindex.h)
+struct winindex_t;
+typedef struct winindex_t winindex_t;
+// what a winindex_t can index windows by
+enum {
+    WINDEX_APP_ID = 0,
+    WINDEX_TITLE,
+    WINDEX_MAX,
+};
+// a window's place in one winindex_t
+typedef struct {
+    struct ws_win_info_t *prev;
+    struct ws_win_info_t *next;
+    // the key it is listed under (owned by the index), NULL if not indexed
+    const char *key;
+} winindex_link_t;
+
+// forward declarations for the leafindex (see leafindex.h)
+struct leafidx_node_t;
+struct leafindex_t;
+typedef struct leafindex_t leafindex_t;
+
+// forward declarations for layout history (see split.h and history.h)
+struct snap_t;
+struct history_t;
+// roots read from the layout file (see layoutfile.h)
+struct saved_root_t;
+
+/* A split is either a leaf frame, or a row (or column) of child frames.  A
+   child never has the same orientation as its parent; that child's children
+   are merged into the parent instead, so repeated splits stay shallow. */
 typedef struct split_t {
     bool isleaf;
     bool isvertical;
     ws_win_info_t *win_info;
-    float fraction;
     struct split_t *parent;
-    struct split_t *frames[2];
+    // which of the parent's frames this is
+    size_t idx;
+    // child frames, frames[i] spans from bounds[i] to bounds[i+1]
+    struct split_t **frames;
+    float *bounds;
+    size_t frames_cap;
+    size_t nframes;
+    // only meaningful for leaves
     screen_t *screen;
+    // leaves are threaded together in screen order, across all roots
+    struct split_t *prev_leaf;
+    struct split_t *next_leaf;
+    /* the last rectangle this leaf was drawn to, valid while it is on a
+       screen; a hidden workspace keeps its leaves indexed with old rects */
+    rect_t rect;
+    // the leafindex node holding this leaf, or NULL if it is not indexed
+    struct leafidx_node_t *leafidx_node;
+    // snapshot of this subtree, or NULL if it changed since the last one
+    struct snap_t *snap;
+    // only meaningful for roots: be_screen_get_id() of the root's screen
+    char *screen_id;
+    // when this leaf last had focus, by its workspace's focus_clock (0=never)
+    uint64_t focused;
+    /* never reused, and kept by whichever leaf stays "the same frame" when
+       frames are split or merged, so a frame can be found again later.  No
+       two live splits share one: a leaf which is split hands its id to its
+       first child and takes a new one. */
+    uint64_t id;
 } split_t;
 
 /* workspace_t has a hashtable of workspace-specific information about each
@@ -68,25 +139,51 @@ typedef struct split_t {
    hashmap has towards any window_t. */
 struct ws_win_info_t {
     window_t *window;
+    struct workspace_t *ws;
+    // the window's other memberships, in other workspaces
+    struct ws_win_info_t *prev_member;
+    struct ws_win_info_t *next_member;
     // frame which points to this window (must be NULL if window is in queue)
     split_t *frame;
     // queue element if window is hidden (must be NULL if window is in a frame)
     struct ws_win_info_t *prev;
     struct ws_win_info_t *next;
+    // the workspace's most-recently-used list, for windows which had focus
+    struct ws_win_info_t *mru_prev;
+    struct ws_win_info_t *mru_next;
+    // places in the workspace's indexes of hidden windows
+    winindex_link_t hidden_by[WINDEX_MAX];
 };
 
-typedef struct {
+typedef struct workspace_t {
+    // unique name, numbered workspaces are just named "1", "2", etc
+    char *name;
     // one root per screen
     split_t **roots;
     size_t roots_size;
     size_t nroots;
     // the focused frame, should always be a leaf
     split_t *focus;
+    // ticks once per workspace_focus_frame(), to stamp split_t.focused
+    uint64_t focus_clock;
     // hashtable of workspace-specific information about each window
     kh_wswl_t *windows;
     // a queue of windows associated with the workspace but which are hidden
     ws_win_info_t *hidden_first;
     ws_win_info_t *hidden_last;
+    // the same hidden windows, by app_id and by title
+    winindex_t *hidden_by[WINDEX_MAX];
+    // windows by when they last had focus, most recent first
+    ws_win_info_t *mru_first;
+    // spatial index of all leaves which are currently on a screen
+    leafindex_t *leafidx;
+    // undo/redo history of the layout
+    struct history_t *history;
+    // roots from the layout file or of unplugged screens, waiting for them
+    struct saved_root_t *saved;
+    // memory pools, so a workspace's objects are near each other in memory
+    slab_t split_slab;
+    slab_t info_slab;
     // pointer to backend
     backend_t *be;
 } workspace_t;
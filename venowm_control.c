@@ -9,7 +9,13 @@
 #include "logmsg.h"
 #include "venowm.h"
 #include "workspace.h"
+#include "window.h"
 #include "split.h"
+#include "slab.h"
+#include "layoutfile.h"
+#include "winsearch.h"
+#include "launch.h"
+#include "winhandle.h"
 
 #include "protocol/venowm-shell-protocol.h"
 
@@ -19,7 +25,7 @@ static void venowm_control_focus_up(struct wl_client *client,
 
     venowm_control_t *vc = wl_resource_get_user_data(resource);
 
-    split_t *new = split_move_up(g_workspace->focus);
+    split_t *new = workspace_neighbor_up(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
     be_repaint(vc->be);
 }
@@ -30,7 +36,7 @@ static void venowm_control_focus_down(struct wl_client *client,
 
     venowm_control_t *vc = wl_resource_get_user_data(resource);
 
-    split_t *new = split_move_down(g_workspace->focus);
+    split_t *new = workspace_neighbor_down(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
     be_repaint(vc->be);
 }
@@ -41,7 +47,7 @@ static void venowm_control_focus_left(struct wl_client *client,
 
     venowm_control_t *vc = wl_resource_get_user_data(resource);
 
-    split_t *new = split_move_left(g_workspace->focus);
+    split_t *new = workspace_neighbor_left(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
     be_repaint(vc->be);
 }
@@ -52,11 +58,262 @@ static void venowm_control_focus_right(struct wl_client *client,
 
     venowm_control_t *vc = wl_resource_get_user_data(resource);
 
-    split_t *new = split_move_right(g_workspace->focus);
+    split_t *new = workspace_neighbor_right(g_workspace, g_workspace->focus);
     workspace_focus_frame(g_workspace, new);
     be_repaint(vc->be);
 }
 
+static void venowm_control_focus_next(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    split_t *new = workspace_next_frame(g_workspace, g_workspace->focus);
+    workspace_focus_frame(g_workspace, new);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_focus_prev(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    split_t *new = workspace_prev_frame(g_workspace, g_workspace->focus);
+    workspace_focus_frame(g_workspace, new);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_only(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_only(g_workspace, g_workspace->focus);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_tile_hidden(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_tile_hidden(g_workspace, g_workspace->focus);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_resize(struct wl_client *client,
+        struct wl_resource *resource, wl_fixed_t dx, wl_fixed_t dy){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    if(dx){
+        workspace_resize(g_workspace, g_workspace->focus, false,
+                (float)wl_fixed_to_double(dx));
+    }
+    if(dy){
+        workspace_resize(g_workspace, g_workspace->focus, true,
+                (float)wl_fixed_to_double(dy));
+    }
+    be_repaint(vc->be);
+}
+
+static void venowm_control_undo(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_undo(g_workspace);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_redo(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_redo(g_workspace);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_save_layout(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+    (void)resource;
+
+    layoutfile_save();
+}
+
+static void venowm_control_switch_workspace(struct wl_client *client,
+        struct wl_resource *resource, const char *name){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_t *ws = workspace_get(name);
+    if(!ws) return;
+    workspace_switch(ws);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_bring_app_id(struct wl_client *client,
+        struct wl_resource *resource, const char *app_id){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_bring_window(g_workspace, g_workspace->focus, WINDEX_APP_ID,
+                           app_id);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_bring_title(struct wl_client *client,
+        struct wl_resource *resource, const char *title){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_bring_window(g_workspace, g_workspace->focus, WINDEX_TITLE,
+                           title);
+    be_repaint(vc->be);
+}
+
+// most search results sent for one query
+#define SEARCH_MAX 64
+
+static void venowm_control_search_windows(struct wl_client *client,
+        struct wl_resource *resource, const char *query, uint32_t max){
+    (void)client;
+
+    winsearch_hit_t hits[SEARCH_MAX];
+    size_t n = winsearch_query(query, hits, max < SEARCH_MAX ? max
+                                                             : SEARCH_MAX);
+    for(size_t i = 0; i < n; i++){
+        window_t *window = hits[i].window;
+        be_window_t *be_window = window->be_window;
+        const char *app_id = be_window_get_app_id(be_window);
+        const char *title = be_window_get_title(be_window);
+        ws_win_info_t *info = window_members(window);
+        venowm_control_send_search_result(resource,
+                (uint32_t)(window->handle >> 32), (uint32_t)window->handle,
+                info ? info->ws->name : "", app_id ? app_id : "",
+                title ? title : "", (uint32_t)hits[i].score);
+    }
+}
+
+static void venowm_control_goto_window(struct wl_client *client,
+        struct wl_resource *resource, const char *query){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    winsearch_hit_t hit;
+    if(!winsearch_query(query, &hit, 1)) return;
+    workspace_goto_window(hit.window);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_last_window(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    workspace_last_window(g_workspace);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_move_to_workspace(struct wl_client *client,
+        struct wl_resource *resource, const char *name){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    split_t *focus = g_workspace->focus;
+    if(!focus || !focus->win_info) return;
+    workspace_t *ws = workspace_get(name);
+    if(!ws) return;
+    workspace_move_window(g_workspace, ws, focus->win_info->window);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_copy_to_workspace(struct wl_client *client,
+        struct wl_resource *resource, const char *name){
+    (void)client;
+
+    split_t *focus = g_workspace->focus;
+    if(!focus || !focus->win_info) return;
+    workspace_t *ws = workspace_get(name);
+    if(!ws) return;
+    // nothing changes on screen
+    workspace_copy_window(ws, focus->win_info->window);
+}
+
+// a window named by a client, or NULL if it has closed since
+static window_t *window_by_id(uint32_t id_hi, uint32_t id_lo){
+    window_t *window = winhandle_get((uint64_t)id_hi << 32 | id_lo);
+    if(!window) logmsg("no window with id %08x%08x\n", id_hi, id_lo);
+    return window;
+}
+
+static void venowm_control_focus_window(struct wl_client *client,
+        struct wl_resource *resource, uint32_t id_hi, uint32_t id_lo){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    window_t *window = window_by_id(id_hi, id_lo);
+    if(!window) return;
+    workspace_goto_window(window);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_close_window(struct wl_client *client,
+        struct wl_resource *resource, uint32_t id_hi, uint32_t id_lo){
+    (void)client;
+    (void)resource;
+
+    window_t *window = window_by_id(id_hi, id_lo);
+    if(!window) return;
+    be_window_close(window->be_window);
+}
+
+static void venowm_control_window_to_workspace(struct wl_client *client,
+        struct wl_resource *resource, uint32_t id_hi, uint32_t id_lo,
+        const char *name){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    window_t *window = window_by_id(id_hi, id_lo);
+    if(!window) return;
+    workspace_t *ws = workspace_get(name);
+    if(!ws) return;
+    workspace_window_to_workspace(window, ws);
+    be_repaint(vc->be);
+}
+
+static void venowm_control_window_to_frame(struct wl_client *client,
+        struct wl_resource *resource, uint32_t id_hi, uint32_t id_lo,
+        uint32_t frame){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    window_t *window = window_by_id(id_hi, id_lo);
+    if(!window || !frame) return;
+    split_t *split = workspace_nth_frame(g_workspace, frame - 1);
+    if(!split) return;
+    workspace_window_to_frame(window, split);
+    be_repaint(vc->be);
+}
+
 static void venowm_control_launch(struct wl_client *client,
         struct wl_resource *resource, struct wl_array *argv_array,
         struct wl_array *argvlen_array){
@@ -144,6 +401,8 @@ static void venowm_control_launch(struct wl_client *client,
         perror("execvp");
         exit(127);
     }
+    // its window opens in the frame it was launched from
+    launch_remember(pid);
 
 cu_argv_copy:
     free(argv_copy);
@@ -151,12 +410,63 @@ done:
     return;
 }
 
+static void venowm_control_get_alloc_stats(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    for(slab_type_t *type = slab_types(); type; type = type->next){
+        venowm_control_send_alloc_stats(resource, type->name,
+                (uint32_t)type->size, (uint32_t)type->live,
+                (uint32_t)type->peak);
+    }
+}
+
+static void send_client_stats(void *data, const be_client_stats_t *stats){
+    struct wl_resource *resource = data;
+    venowm_control_send_client_stats(resource, (uint32_t)stats->pid,
+            stats->app_id ? stats->app_id : "", stats->surfaces,
+            (uint32_t)(stats->buffer_bytes >> 10), stats->commits_per_sec,
+            stats->frames_per_sec, stats->configure_avg_us,
+            stats->configure_max_us);
+}
+
+static void venowm_control_get_client_stats(struct wl_client *client,
+        struct wl_resource *resource){
+    (void)client;
+
+    venowm_control_t *vc = wl_resource_get_user_data(resource);
+
+    be_client_stats(vc->be, send_client_stats, resource);
+}
+
 static const struct venowm_control_interface venowm_control_impl = {
     venowm_control_focus_up,
     venowm_control_focus_down,
     venowm_control_focus_left,
     venowm_control_focus_right,
     venowm_control_launch,
+    venowm_control_get_alloc_stats,
+    venowm_control_focus_next,
+    venowm_control_focus_prev,
+    venowm_control_only,
+    venowm_control_tile_hidden,
+    venowm_control_resize,
+    venowm_control_undo,
+    venowm_control_redo,
+    venowm_control_save_layout,
+    venowm_control_switch_workspace,
+    venowm_control_bring_app_id,
+    venowm_control_bring_title,
+    venowm_control_search_windows,
+    venowm_control_goto_window,
+    venowm_control_last_window,
+    venowm_control_move_to_workspace,
+    venowm_control_copy_to_workspace,
+    venowm_control_focus_window,
+    venowm_control_close_window,
+    venowm_control_window_to_workspace,
+    venowm_control_window_to_frame,
+    venowm_control_get_client_stats,
 };
 
 static void unbind_venowm_control(struct wl_resource *resource){
@@ -1,22 +1,137 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdlib.h>
+#include <string.h>
 
 #include "window.h"
 #include "workspace.h"
 #include "split.h"
+#include "winsearch.h"
+#include "rules.h"
+#include "launch.h"
+#include "winhandle.h"
 
-int handle_window_new(be_window_t *be_window, void **data){
+static slab_type_t window_slab_type = SLAB_TYPE(window_t);
+static slab_t window_slab = {.type = &window_slab_type};
+
+/* Where a new window goes, picked at its first commit so that the first size
+   it is sent is its frame's.  The workspace is kept by name and the frame by
+   id, since either might be gone by the time the window maps. */
+typedef struct {
+    char *workspace;
+    // split_t.id, or 0 for the focused frame if it is empty
+    uint64_t frame;
+    bool hidden;
+} plan_t;
+
+// the size a window gets in a frame, left alone if it won't be on a screen
+static void frame_size(workspace_t *ws, split_t *frame,
+                       uint32_t *w, uint32_t *h){
+    if(ws != g_workspace || !frame || !frame->screen) return;
+    *w = (uint32_t)(frame->rect.r - frame->rect.l);
+    *h = (uint32_t)(frame->rect.b - frame->rect.t);
+}
+
+/* the frame it was launched from, or where the rules say.  *frame is NULL
+   for the focused frame if that is empty, or else hidden.  Returns false if
+   neither says. */
+static bool pick_place(be_window_t *be_window, workspace_t **ws,
+                       split_t **frame, bool *hidden){
+    *hidden = false;
+    if(launch_claim(be_window_get_pid(be_window), ws, frame)) return true;
+    rule_target_t target;
+    if(!rules_match(be_window_get_app_id(be_window),
+                    be_window_get_title(be_window), &target)){
+        return false;
+    }
+    *ws = g_workspace;
+    if(target.workspace){
+        *ws = workspace_get(target.workspace);
+        if(!*ws) *ws = g_workspace;
+    }
+    *hidden = target.hidden;
+    *frame = NULL;
+    if(!target.hidden && target.frame != SIZE_MAX){
+        *frame = workspace_nth_frame(*ws, target.frame);
+    }
+    return true;
+}
+
+void *handle_window_plan(be_window_t *be_window, uint32_t *w, uint32_t *h){
+    workspace_t *ws;
+    split_t *frame;
+    bool hidden;
+    if(!pick_place(be_window, &ws, &frame, &hidden)){
+        // it goes in the focused frame
+        frame_size(g_workspace, g_workspace->focus, w, h);
+        return NULL;
+    }
+    plan_t *plan = malloc(sizeof(*plan));
+    if(!plan) goto fail;
+    plan->workspace = strdup(ws->name);
+    if(!plan->workspace) goto fail_plan;
+    plan->frame = frame ? frame->id : 0;
+    plan->hidden = hidden;
+    // the focused frame only takes it if it is empty, like rules.h says
+    if(!frame && ws->focus && !ws->focus->win_info) frame = ws->focus;
+    if(!hidden) frame_size(ws, frame, w, h);
+    return plan;
+
+fail_plan:
+    free(plan);
+fail:
+    logmsg("no memory to plan a window\n");
+    return NULL;
+}
+
+void handle_window_plan_drop(void *data){
+    plan_t *plan = data;
+    if(!plan) return;
+    free(plan->workspace);
+    free(plan);
+}
+
+/* Put a new window where its plan says, or else in the focused frame.  A
+   window sent to a workspace in the background isn't resized until that
+   workspace is shown. */
+static void place_window(window_t *window, plan_t *plan){
+    workspace_t *ws = plan ? workspace_find(plan->workspace) : NULL;
+    if(!ws){
+        // mapping/focusing it immediately
+        workspace_add_window(g_workspace, window, true);
+        return;
+    }
+    if(plan->hidden){
+        workspace_add_window_to(ws, window, NULL);
+        return;
+    }
+    split_t *frame = NULL;
+    if(plan->frame) frame = workspace_frame_by_id(ws, plan->frame);
+    if(frame){
+        workspace_add_window_to(ws, window, frame);
+        return;
+    }
+    // the focused frame only takes it if it is empty, like rules.h says
+    workspace_copy_window(ws, window);
+}
+
+int handle_window_new(be_window_t *be_window, void *plan, void **data){
     logmsg("new window\n");
     // wrap this window in a new window_t
     window_t *window = window_new(be_window);
     if(!window){
+        handle_window_plan_drop(plan);
         /* oops, no memory.  Close the window.  No handler will been set, so we
            don't need to worry about receiving a window.destroy hook */
         logmsg("no memory! closing window");
         be_window_close(be_window);
         return -1;
     }
-    // add window to the current workspace, mapping/focusing it immediately
-    workspace_add_window(g_workspace, window, true);
+    // windows on every workspace can be searched for
+    if(winsearch_add(window)){
+        logmsg("no memory to make window searchable\n");
+    }
+    place_window(window, plan);
+    handle_window_plan_drop(plan);
     // set callback data
     *data = window;
     return 0;
@@ -27,17 +142,31 @@ void handle_window_destroy(void *data){
     // dereference window_t
     window_t *window = data;
     window->isvalid = false;
-    // go through each workspace and remove this window
-    for(size_t i = 0; i < g_nworkspaces; i++){
-        workspace_remove_window(g_workspaces[i], window);
+    winsearch_remove(window);
+    winhandle_release(window->handle);
+    // remove this window from each workspace it is in
+    while(window->members){
+        workspace_t *ws = window->members->ws;
+        workspace_remove_window(ws, window);
+        // a background workspace might be empty now
+        workspace_reclaim(ws);
     }
     // no more references to window, free it
-    free(window);
+    slab_free(window);
+}
+
+void handle_window_props(void *data){
+    window_t *window = data;
+    winsearch_update(window);
+    // hidden windows are indexed by their title and app_id
+    for(ws_win_info_t *info = window->members; info; info = info->next_member){
+        workspace_reindex_window(info->ws, info);
+    }
 }
 
 // the returned window starts with 0 refs
 window_t *window_new(be_window_t *be_window){
-    window_t *out = malloc(sizeof(*out));
+    window_t *out = slab_alloc(&window_slab);
     if(out == NULL){
         return NULL;
     }
@@ -47,6 +176,10 @@ window_t *window_new(be_window_t *be_window){
     out->be_window = be_window;
     // set defaults
     out->refs = 0;
+    out->members = NULL;
+    out->search = NULL;
+    // without a handle, clients just can't name this window
+    out->handle = winhandle_new(out);
     out->isvalid = true;
     return out;
 }
@@ -55,6 +188,31 @@ void window_ref_up(window_t *window){
     window->refs++;
 }
 
+void window_add_member(window_t *window, ws_win_info_t *info){
+    info->prev_member = NULL;
+    info->next_member = window->members;
+    if(window->members) window->members->prev_member = info;
+    window->members = info;
+}
+
+void window_remove_member(window_t *window, ws_win_info_t *info){
+    if(info->prev_member){
+        info->prev_member->next_member = info->next_member;
+    }else{
+        window->members = info->next_member;
+    }
+    if(info->next_member) info->next_member->prev_member = info->prev_member;
+    info->prev_member = NULL;
+    info->next_member = NULL;
+}
+
+ws_win_info_t *window_member_of(window_t *window, workspace_t *ws){
+    for(ws_win_info_t *info = window->members; info; info = info->next_member){
+        if(info->ws == ws) return info;
+    }
+    return NULL;
+}
+
 void window_ref_down(window_t *window){
     if(--window->refs < 1){
         // make sure the be_window has not already closed
@@ -9,6 +9,18 @@ window_t *window_new(be_window_t *be_window);
 void window_ref_up(window_t *window);
 void window_ref_down(window_t *window);
 
+/* Each window keeps a list of the ws_win_info_t of every workspace it is in,
+   so finding or leaving those workspaces never has to look at the others.
+   The workspace calls these when it adds or removes a window. */
+void window_add_member(window_t *window, ws_win_info_t *info);
+void window_remove_member(window_t *window, ws_win_info_t *info);
+// the first membership, follow ->next_member for the rest
+static inline ws_win_info_t *window_members(window_t *window){
+    return window->members;
+}
+// the window's ws_win_info_t in one workspace, or NULL if it isn't there
+ws_win_info_t *window_member_of(window_t *window, workspace_t *ws);
+
 void window_map(window_t *window, split_t *frame);
 void window_unmap(window_t *window);
 
@@ -0,0 +1,62 @@
+#include <stdlib.h>
+
+#include "winhandle.h"
+
+// end of the free list
+#define NO_SLOT UINT32_MAX
+
+typedef struct {
+    // NULL for a free slot
+    window_t *window;
+    // never 0, so no handle is 0
+    uint32_t gen;
+    uint32_t next_free;
+} slot_t;
+
+static slot_t *slots = NULL;
+static size_t slots_size = 0;
+static size_t nslots = 0;
+// free slots are reused last-freed first
+static uint32_t free_head = NO_SLOT;
+
+uint64_t winhandle_new(window_t *window){
+    uint32_t idx;
+    if(free_head != NO_SLOT){
+        idx = free_head;
+        free_head = slots[idx].next_free;
+    }else{
+        int err = 0;
+        if(!slots) INIT_PTR(slots, slots_size, nslots, 64, err);
+        if(err || nslots == NO_SLOT) return 0;
+        slot_t slot = {.gen = 1, .next_free = NO_SLOT};
+        APPEND_PTR(slots, slots_size, nslots, slot, err);
+        if(err) return 0;
+        idx = (uint32_t)(nslots - 1);
+    }
+    slots[idx].window = window;
+    return (uint64_t)slots[idx].gen << 32 | idx;
+}
+
+window_t *winhandle_get(uint64_t handle){
+    uint32_t idx = (uint32_t)handle;
+    if(idx >= nslots || slots[idx].gen != (uint32_t)(handle >> 32)){
+        return NULL;
+    }
+    return slots[idx].window;
+}
+
+void winhandle_release(uint64_t handle){
+    if(!winhandle_get(handle)) return;
+    uint32_t idx = (uint32_t)handle;
+    slots[idx].window = NULL;
+    // every old handle to this slot is stale now
+    if(++slots[idx].gen == 0) slots[idx].gen = 1;
+    slots[idx].next_free = free_head;
+    free_head = idx;
+}
+
+void winhandle_free(void){
+    FREE_PTR(slots, slots_size, nslots);
+    slots = NULL;
+    free_head = NO_SLOT;
+}
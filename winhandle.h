@@ -0,0 +1,21 @@
+#ifndef WINHANDLE_H
+#define WINHANDLE_H
+
+#include "venowm.h"
+
+/* Window handles are how clients name windows, since window_t pointers are
+   reused as soon as a window closes.  A handle is a slot in a table plus the
+   slot's generation, which goes up every time the slot is let go.  Lookups
+   are O(1), and a handle to a closed window never finds the window which
+   took its slot.  Anything which outlives a window, like the layout
+   snapshots for undo and parked screens, should hold its handle too. */
+
+// returns the new window's handle, or 0 for no memory
+uint64_t winhandle_new(window_t *window);
+// the window is closing, noop for handle 0
+void winhandle_release(uint64_t handle);
+// the window with this handle, or NULL if it's gone
+window_t *winhandle_get(uint64_t handle);
+void winhandle_free(void);
+
+#endif // WINHANDLE_H
@@ -0,0 +1,96 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <string.h>
+
+#include "winindex.h"
+
+// each key maps to the first window of a circular list
+KHASH_MAP_INIT_STR(winidx, ws_win_info_t*)
+
+struct winindex_t {
+    khash_t(winidx) *keys;
+    // which of info->hidden_by[] belongs to this index
+    int which;
+};
+
+#define LINK(info) (&(info)->hidden_by[idx->which])
+
+winindex_t *winindex_new(int which){
+    winindex_t *idx = malloc(sizeof(*idx));
+    if(!idx) return NULL;
+    idx->keys = kh_init(winidx);
+    if(!idx->keys){
+        free(idx);
+        return NULL;
+    }
+    idx->which = which;
+    return idx;
+}
+
+void winindex_free(winindex_t *idx){
+    if(!idx) return;
+    for(khiter_t k = kh_begin(idx->keys); k != kh_end(idx->keys); k++){
+        if(kh_exist(idx->keys, k)) free((char*)kh_key(idx->keys, k));
+    }
+    kh_destroy(winidx, idx->keys);
+    free(idx);
+}
+
+int winindex_add(winindex_t *idx, ws_win_info_t *info, const char *key){
+    if(!key) key = "";
+    winindex_link_t *link = LINK(info);
+    khiter_t k = kh_get(winidx, idx->keys, key);
+    if(k != kh_end(idx->keys)){
+        // goes at the back of the queue, just before the first window
+        ws_win_info_t *first = kh_value(idx->keys, k);
+        ws_win_info_t *last = LINK(first)->prev;
+        link->prev = last;
+        link->next = first;
+        LINK(last)->next = info;
+        LINK(first)->prev = info;
+        link->key = kh_key(idx->keys, k);
+        return 0;
+    }
+    // a new key, which the index keeps its own copy of
+    char *copy = strdup(key);
+    if(!copy) return -1;
+    int ret;
+    k = kh_put(winidx, idx->keys, copy, &ret);
+    if(ret < 0){
+        free(copy);
+        return -1;
+    }
+    kh_value(idx->keys, k) = info;
+    link->prev = info;
+    link->next = info;
+    link->key = copy;
+    return 0;
+}
+
+void winindex_remove(winindex_t *idx, ws_win_info_t *info){
+    winindex_link_t *link = LINK(info);
+    if(!link->key) return;
+    khiter_t k = kh_get(winidx, idx->keys, link->key);
+    if(link->next == info){
+        // the last window with this key
+        char *key = (char*)kh_key(idx->keys, k);
+        kh_del(winidx, idx->keys, k);
+        free(key);
+    }else{
+        LINK(link->prev)->next = link->next;
+        LINK(link->next)->prev = link->prev;
+        if(kh_value(idx->keys, k) == info){
+            kh_value(idx->keys, k) = link->next;
+        }
+    }
+    link->prev = NULL;
+    link->next = NULL;
+    link->key = NULL;
+}
+
+ws_win_info_t *winindex_get(winindex_t *idx, const char *key){
+    if(!key) key = "";
+    khiter_t k = kh_get(winidx, idx->keys, key);
+    if(k == kh_end(idx->keys)) return NULL;
+    return kh_value(idx->keys, k);
+}
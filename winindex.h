@@ -0,0 +1,28 @@
+#ifndef WININDEX_H
+#define WININDEX_H
+
+#include "venowm.h"
+
+/* A winindex_t finds windows by a string, such as their app_id or their
+   title.  Each key has a queue of the windows listed under it, oldest first,
+   so finding, adding and removing a window are all O(1).
+
+   The queues are threaded through info->hidden_by[which], so an index needs
+   no memory of its own besides one copy of each key. */
+
+winindex_t *winindex_new(int which);
+// the windows are left alone, but their links are no longer valid
+void winindex_free(winindex_t *idx);
+
+/* list a window under a key, behind any other windows with that key.  A NULL
+   key is the same as "".  Returns 0, or -1 for no memory (then the window is
+   not indexed). */
+int winindex_add(winindex_t *idx, ws_win_info_t *info, const char *key);
+
+// noop if the window is not indexed
+void winindex_remove(winindex_t *idx, ws_win_info_t *info);
+
+// the oldest window listed under a key, or NULL
+ws_win_info_t *winindex_get(winindex_t *idx, const char *key);
+
+#endif // WININDEX_H
@@ -0,0 +1,298 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "winsearch.h"
+
+// titles can be silly long, and the start of them is what people type
+#define TEXT_MAX 256
+
+typedef struct winsearch_entry_t {
+    window_t *window;
+    // lowercase "app_id title"
+    char *text;
+    size_t len;
+    // the trigrams of text, sorted and without duplicates
+    uint32_t *grams;
+    size_t ngrams;
+    // where this entry is in entries[]
+    size_t idx;
+    // scratch space for winsearch_query()
+    uint64_t query;
+    size_t hits;
+    int score;
+} entry_t;
+
+// every window which has a trigram
+typedef struct {
+    entry_t **entries;
+    size_t size;
+    size_t num;
+} posting_t;
+
+KHASH_MAP_INIT_INT(trigram, posting_t)
+
+static khash_t(trigram) *postings = NULL;
+
+// every window, for queries too short to have trigrams
+static entry_t **entries = NULL;
+static size_t entries_size = 0;
+static size_t nentries = 0;
+
+// the windows a query has looked at so far
+static entry_t **found = NULL;
+static size_t found_size = 0;
+static size_t nfound = 0;
+static uint64_t nqueries = 0;
+
+static void fold(char *s){
+    for(; *s; s++) *s = (char)tolower((unsigned char)*s);
+}
+
+static int cmp_gram(const void *a, const void *b){
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// the sorted, unique trigrams of a string, returns 0 or -1
+static int get_grams(const char *s, uint32_t **out, size_t *n){
+    size_t len = strlen(s);
+    *out = NULL;
+    *n = 0;
+    if(len < 3) return 0;
+    uint32_t *grams = malloc(sizeof(*grams) * (len - 2));
+    if(!grams) return -1;
+    const unsigned char *u = (const unsigned char*)s;
+    for(size_t i = 0; i + 2 < len; i++){
+        grams[i] = (uint32_t)u[i] << 16 | (uint32_t)u[i+1] << 8 | u[i+2];
+    }
+    qsort(grams, len - 2, sizeof(*grams), cmp_gram);
+    size_t count = 1;
+    for(size_t i = 1; i < len - 2; i++){
+        if(grams[i] != grams[count - 1]) grams[count++] = grams[i];
+    }
+    *out = grams;
+    *n = count;
+    return 0;
+}
+
+static int posting_add(uint32_t gram, entry_t *e){
+    int ret;
+    khiter_t k = kh_put(trigram, postings, gram, &ret);
+    if(ret < 0) return -1;
+    posting_t *p = &kh_value(postings, k);
+    int err;
+    if(ret){
+        // a trigram nobody had yet
+        INIT_PTR(p->entries, p->size, p->num, 4, err);
+        if(err){
+            kh_del(trigram, postings, k);
+            return -1;
+        }
+    }
+    APPEND_PTR(p->entries, p->size, p->num, e, err);
+    return err;
+}
+
+static void posting_remove(uint32_t gram, entry_t *e){
+    khiter_t k = kh_get(trigram, postings, gram);
+    if(k == kh_end(postings)) return;
+    posting_t *p = &kh_value(postings, k);
+    for(size_t i = 0; i < p->num; i++){
+        if(p->entries[i] != e) continue;
+        // the order doesn't matter, so the last one fills the hole
+        p->entries[i] = p->entries[--p->num];
+        break;
+    }
+    if(!p->num){
+        FREE_PTR(p->entries, p->size, p->num);
+        kh_del(trigram, postings, k);
+    }
+}
+
+/* Move an entry from its old trigrams to new ones, which it takes ownership
+   of.  Trigrams in both lists are left alone, and when a title changes a
+   little that is most of them. */
+static void regram(entry_t *e, uint32_t *grams, size_t ngrams){
+    uint32_t *old = e->grams;
+    size_t nold = e->ngrams;
+    size_t i = 0;
+    size_t j = 0;
+    // new trigrams which couldn't be added are dropped from the list
+    size_t kept = 0;
+    while(i < nold || j < ngrams){
+        if(j == ngrams || (i < nold && old[i] < grams[j])){
+            posting_remove(old[i++], e);
+        }else if(i == nold || grams[j] < old[i]){
+            if(posting_add(grams[j], e) == 0) grams[kept++] = grams[j];
+            j++;
+        }else{
+            grams[kept++] = grams[j];
+            i++;
+            j++;
+        }
+    }
+    free(old);
+    e->grams = grams;
+    e->ngrams = kept;
+}
+
+int winsearch_add(window_t *window){
+    int err = 0;
+    if(!postings){
+        postings = kh_init(trigram);
+        if(!postings) return -1;
+    }
+    if(!entries){
+        INIT_PTR(entries, entries_size, nentries, 64, err);
+        if(err) return -1;
+    }
+    entry_t *e = malloc(sizeof(*e));
+    if(!e) return -1;
+    *e = (entry_t){.window = window, .idx = nentries};
+    APPEND_PTR(entries, entries_size, nentries, e, err);
+    if(err){
+        free(e);
+        return -1;
+    }
+    window->search = e;
+    winsearch_update(window);
+    return 0;
+}
+
+void winsearch_update(window_t *window){
+    entry_t *e = window->search;
+    if(!e) return;
+    be_window_t *be_window = window->be_window;
+    const char *app_id = be_window_get_app_id(be_window);
+    const char *title = be_window_get_title(be_window);
+    char text[TEXT_MAX + 1];
+    snprintf(text, sizeof(text), "%s %s", app_id ? app_id : "",
+             title ? title : "");
+    fold(text);
+    // the title is often set again to what it already was
+    if(e->text && strcmp(e->text, text) == 0) return;
+
+    char *copy = strdup(text);
+    uint32_t *grams;
+    size_t ngrams;
+    if(!copy || get_grams(text, &grams, &ngrams)){
+        free(copy);
+        logmsg("no memory to index window for search\n");
+        return;
+    }
+    regram(e, grams, ngrams);
+    free(e->text);
+    e->text = copy;
+    e->len = strlen(copy);
+}
+
+void winsearch_remove(window_t *window){
+    entry_t *e = window->search;
+    if(!e) return;
+    regram(e, NULL, 0);
+    entries[e->idx] = entries[--nentries];
+    entries[e->idx]->idx = e->idx;
+    free(e->text);
+    free(e);
+    window->search = NULL;
+}
+
+void winsearch_free(void){
+    // the windows may be gone already, so don't touch them
+    for(size_t i = 0; i < nentries; i++){
+        free(entries[i]->grams);
+        free(entries[i]->text);
+        free(entries[i]);
+    }
+    FREE_PTR(entries, entries_size, nentries);
+    entries = NULL;
+    FREE_PTR(found, found_size, nfound);
+    found = NULL;
+    if(postings){
+        for(khiter_t k = kh_begin(postings); k != kh_end(postings); k++){
+            if(!kh_exist(postings, k)) continue;
+            posting_t *p = &kh_value(postings, k);
+            FREE_PTR(p->entries, p->size, p->num);
+        }
+        kh_destroy(trigram, postings);
+        postings = NULL;
+    }
+}
+
+static void add_found(entry_t *e){
+    int err = 0;
+    if(!found) INIT_PTR(found, found_size, nfound, 64, err);
+    // running out of memory here just makes for fewer results
+    if(!err) APPEND_PTR(found, found_size, nfound, e, err);
+}
+
+static int cmp_found(const void *a, const void *b){
+    const entry_t *x = *(entry_t *const*)a;
+    const entry_t *y = *(entry_t *const*)b;
+    if(x->score != y->score) return y->score - x->score;
+    // a shorter text is a closer match
+    return (x->len > y->len) - (x->len < y->len);
+}
+
+size_t winsearch_query(const char *query, winsearch_hit_t *out, size_t max){
+    if(!max || !nentries) return 0;
+    char q[TEXT_MAX + 1];
+    snprintf(q, sizeof(q), "%s", query);
+    fold(q);
+    if(!*q) return 0;
+    uint32_t *grams;
+    size_t ngrams;
+    if(get_grams(q, &grams, &ngrams)) return 0;
+
+    // count how many of the query's trigrams each window has
+    nqueries++;
+    nfound = 0;
+    if(!ngrams){
+        // too short for trigrams, so it has to be a plain substring
+        for(size_t i = 0; i < nentries; i++){
+            if(strstr(entries[i]->text, q)) add_found(entries[i]);
+        }
+    }
+    for(size_t i = 0; i < ngrams; i++){
+        khiter_t k = kh_get(trigram, postings, grams[i]);
+        if(k == kh_end(postings)) continue;
+        posting_t *p = &kh_value(postings, k);
+        for(size_t j = 0; j < p->num; j++){
+            entry_t *e = p->entries[j];
+            if(e->query != nqueries){
+                e->query = nqueries;
+                e->hits = 0;
+                add_found(e);
+            }
+            e->hits++;
+        }
+    }
+    free(grams);
+
+    // score the windows with enough of the query, and drop the rest
+    size_t n = 0;
+    for(size_t i = 0; i < nfound; i++){
+        entry_t *e = found[i];
+        if(ngrams && e->hits * 2 < ngrams) continue;
+        e->score = ngrams ? (int)(e->hits * 100 / ngrams) : 100;
+        const char *at = strstr(e->text, q);
+        if(at){
+            e->score += 100;
+            // even better at the start of a word
+            if(at == e->text || !isalnum((unsigned char)at[-1])){
+                e->score += 50;
+            }
+        }
+        found[n++] = e;
+    }
+    qsort(found, n, sizeof(*found), cmp_found);
+    if(n > max) n = max;
+    for(size_t i = 0; i < n; i++){
+        out[i] = (winsearch_hit_t){found[i]->window, found[i]->score};
+    }
+    return n;
+}
@@ -0,0 +1,38 @@
+#ifndef WINSEARCH_H
+#define WINSEARCH_H
+
+#include "venowm.h"
+
+/* The window search index finds windows on every workspace by a few typed
+   characters, matched against their app_id and title.
+
+   Each window's text is cut into trigrams (every run of three characters,
+   ignoring case), and each trigram maps to the windows containing it.  A
+   query only looks at the windows sharing a trigram with it, so it costs
+   about the same with 10 windows or 1000.  When a title changes, only the
+   trigrams which came or went are touched.
+
+   Matches are fuzzy: a window only needs half of the query's trigrams, so a
+   typo or two still finds it.  They are ranked by how much of the query
+   they contain, with a bonus for containing it word for word. */
+
+typedef struct {
+    window_t *window;
+    // bigger is better
+    int score;
+} winsearch_hit_t;
+
+// returns 0, or -1 for no memory (then the window just can't be found)
+int winsearch_add(window_t *window);
+// the window's title or app_id changed
+void winsearch_update(window_t *window);
+// noop if the window isn't in the index
+void winsearch_remove(window_t *window);
+// forget every window
+void winsearch_free(void);
+
+/* Write up to max of the best matches to out[], best first, and return how
+   many there were. */
+size_t winsearch_query(const char *query, winsearch_hit_t *out, size_t max);
+
+#endif // WINSEARCH_H
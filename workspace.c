@@ -1,37 +1,101 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 
 #include "venowm.h"
 #include "workspace.h"
 #include "split.h"
 #include "window.h"
 #include "backend.h"
+#include "leafindex.h"
+#include "history.h"
+#include "layoutfile.h"
+#include "winindex.h"
+#include "winhandle.h"
+
+static slab_type_t info_slab_type = SLAB_TYPE(ws_win_info_t);
 
 workspace_t *workspace_new(backend_t *be){
     workspace_t *ws = malloc(sizeof(*ws));
     if(!ws) return NULL;
 
     ws->windows = kh_init(wswl);
-    if(!ws) goto cu_malloc;
+    if(!ws->windows) goto cu_malloc;
+
+    // the name is set by workspace_get()
+    ws->name = NULL;
+
+    // no frames until the first workspace_restore()
+    ws->focus = NULL;
+    ws->focus_clock = 0;
 
     // no hidden windows yet
     ws->hidden_first = NULL;
     ws->hidden_last = NULL;
+    ws->mru_first = NULL;
+
+    for(int i = 0; i < WINDEX_MAX; i++){
+        ws->hidden_by[i] = winindex_new(i);
+    }
+    for(int i = 0; i < WINDEX_MAX; i++){
+        if(!ws->hidden_by[i]) goto cu_hidden_by;
+    }
 
     int err;
     INIT_PTR(ws->roots, ws->roots_size, ws->nroots, 8, err);
-    if(err) goto cu_windows;
+    if(err) goto cu_hidden_by;
+
+    ws->leafidx = leafindex_new();
+    if(!ws->leafidx) goto cu_roots;
+
+    ws->history = history_new();
+    if(!ws->history) goto cu_leafidx;
+
+    ws->saved = NULL;
+
+    slab_init(&ws->split_slab, &split_slab_type);
+    slab_init(&ws->info_slab, &info_slab_type);
 
     ws->be = be;
     return ws;
 
-cu_windows:
+cu_leafidx:
+    leafindex_free(ws->leafidx);
+cu_roots:
+    FREE_PTR(ws->roots, ws->roots_size, ws->nroots);
+cu_hidden_by:
+    for(int i = 0; i < WINDEX_MAX; i++){
+        winindex_free(ws->hidden_by[i]);
+    }
     kh_destroy(wswl, ws->windows);
 cu_malloc:
     free(ws);
     return NULL;
 }
 
+/* Hidden windows are also indexed by app_id and title, so one can be picked
+   out by name without cycling through the others.  Windows which are
+   closing aren't worth indexing. */
+static void hidden_index(workspace_t *ws, ws_win_info_t *info){
+    be_window_t *be_window = info->window->be_window;
+    if(!info->window->isvalid) return;
+    if(winindex_add(ws->hidden_by[WINDEX_APP_ID], info,
+                    be_window_get_app_id(be_window))
+            || winindex_add(ws->hidden_by[WINDEX_TITLE], info,
+                            be_window_get_title(be_window))){
+        logmsg("no memory to index hidden window\n");
+    }
+}
+
+static void hidden_unindex(workspace_t *ws, ws_win_info_t *info){
+    for(int i = 0; i < WINDEX_MAX; i++){
+        winindex_remove(ws->hidden_by[i], info);
+    }
+}
+
 static void hidden_prepend(workspace_t *ws, ws_win_info_t *info){
+    hidden_index(ws, info);
     // if list is empty, info becomes first and last
     if(ws->hidden_first == NULL){
         ws->hidden_first = info;
@@ -48,6 +112,7 @@ static void hidden_prepend(workspace_t *ws, ws_win_info_t *info){
 }
 
 static void hidden_append(workspace_t *ws, ws_win_info_t *info){
+    hidden_index(ws, info);
     // if list is empty, info becomes first and last
     if(ws->hidden_last == NULL){
         ws->hidden_first = info;
@@ -77,6 +142,7 @@ static ws_win_info_t *hidden_pop_first(workspace_t *ws){
     }
     out->prev = NULL;
     out->next = NULL;
+    hidden_unindex(ws, out);
     return out;
 }
 
@@ -94,10 +160,12 @@ static ws_win_info_t *hidden_pop_last(workspace_t *ws){
     }
     out->prev = NULL;
     out->next = NULL;
+    hidden_unindex(ws, out);
     return out;
 }
 
 static void hidden_remove(workspace_t *ws, ws_win_info_t *info){
+    hidden_unindex(ws, info);
     // was it the first element?
     if(ws->hidden_first == info)
         ws->hidden_first = info->next;
@@ -114,6 +182,33 @@ static void hidden_remove(workspace_t *ws, ws_win_info_t *info){
     info->next = NULL;
 }
 
+static void mru_remove(workspace_t *ws, ws_win_info_t *info){
+    if(ws->mru_first == info) ws->mru_first = info->mru_next;
+    if(info->mru_prev) info->mru_prev->mru_next = info->mru_next;
+    if(info->mru_next) info->mru_next->mru_prev = info->mru_prev;
+    info->mru_prev = NULL;
+    info->mru_next = NULL;
+}
+
+// mark a window as the most recently used
+static void mru_touch(workspace_t *ws, ws_win_info_t *info){
+    if(ws->mru_first == info) return;
+    mru_remove(ws, info);
+    info->mru_next = ws->mru_first;
+    if(ws->mru_first) ws->mru_first->mru_prev = info;
+    ws->mru_first = info;
+}
+
+/* the hidden window which had focus most recently, or else the first hidden
+   window, or NULL.  Windows on screen are usually at the front of the MRU
+   list, so this rarely looks at more than a few of them. */
+static ws_win_info_t *recent_hidden(workspace_t *ws){
+    for(ws_win_info_t *info = ws->mru_first; info; info = info->mru_next){
+        if(!info->frame) return info;
+    }
+    return ws->hidden_first;
+}
+
 // frees all of its roots, downrefs all of its windows
 void workspace_free(workspace_t *ws){
     // iterate through all windows via hashmap
@@ -128,66 +223,91 @@ void workspace_free(workspace_t *ws){
             // remove from hidden list
             hidden_remove(ws, info);
             // no more references from this workspace
+            window_remove_member(info->window, info);
             window_ref_down(info->window);
-            free(info);
+            slab_free(info);
         }
     }
     kh_destroy(wswl, ws->windows);
+    for(int i = 0; i < WINDEX_MAX; i++){
+        winindex_free(ws->hidden_by[i]);
+    }
+    history_free(ws->history);
+    saved_root_free(ws->saved);
+    // the index points into the roots, so free it first
+    leafindex_free(ws->leafidx);
     // now free all of the ws->nroots
     for(size_t i = 0; i < ws->nroots; i++){
         split_free(ws->roots[i]);
     }
     FREE_PTR(ws->roots, ws->roots_size, ws->nroots);
+    slab_deinit(&ws->split_slab);
+    slab_deinit(&ws->info_slab);
+    free(ws->name);
     free(ws);
 }
 
-static void redraw_frame(split_t *frame, screen_t *screen,
-                         float t, float b, float l, float r){
+// convert relative boundaries on a screen to global coordinates
+static rect_t frame_rect(screen_t *screen, float t, float b, float l, float r){
     // pull out screen geometry
     int32_t x, y;
     uint32_t w, h;
     be_screen_get_geometry(screen->be_screen, &x, &y, &w, &h);
-    // build window geometry
     // TODO: decide how to do the offsets to avoid skipping/overlapping pixels
-    int32_t xmin = x + frac_of(l, (int)w);
-    int32_t xmax = x + frac_of(r, (int)w);
-    int32_t ymin = y + frac_of(t, (int)h);
-    int32_t ymax = y + frac_of(b, (int)h);
-    uint32_t wout = xmax - xmin;
-    uint32_t hout = ymax - ymin;
+    return (rect_t){
+        .t = y + frac_of(t, (int)h),
+        .b = y + frac_of(b, (int)h),
+        .l = x + frac_of(l, (int)w),
+        .r = x + frac_of(r, (int)w),
+    };
+}
+
+/* index a leaf at its new geometry, and draw its window there (if it has one).
+   Leaves are indexed whether or not they have a window, since empty frames
+   can still be navigated to. */
+static void redraw_frame(workspace_t *ws, split_t *frame, screen_t *screen,
+                         float t, float b, float l, float r){
+    rect_t rect = frame_rect(screen, t, b, l, r);
+    if(leafindex_set(ws->leafidx, frame, rect)){
+        logmsg("no memory to index frame\n");
+    }
+    if(!frame->win_info) return;
+    uint32_t wout = rect.r - rect.l;
+    uint32_t hout = rect.b - rect.t;
     // make window visible and set the geometry
     be_window_t *be_window = frame->win_info->window->be_window;
-    be_window_geometry(be_window, xmin, ymin, wout, hout);
-    logmsg("x,y = %d,%d  w,h = %u,%u\n", xmin, ymin, wout, hout);
+    be_window_geometry(be_window, rect.l, rect.t, wout, hout);
+    logmsg("x,y = %d,%d  w,h = %u,%u\n", rect.l, rect.t, wout, hout);
     be_window_show(be_window, screen->be_screen);
 }
 
-static void draw_window(ws_win_info_t *info, split_t *frame){
+static void draw_window(workspace_t *ws, ws_win_info_t *info, split_t *frame){
     // "draw window in NULL" -> noop
     if(!frame) return;
     // "draw NULL in frame" -> erase win_info in that frame
+    split_touch(frame);
     frame->win_info = info;
-    if(!info) return;
-    info->frame = frame;
-    // don't actually redraw the window unless it is on screen
+    if(info) info->frame = frame;
+    // don't actually redraw anything unless it is on screen
     if(!frame->screen) return;
     // get the geometry of the window
     sides_t sides = get_sides(frame);
     float t = sides.t, b = sides.b, l = sides.l, r = sides.r;
     // draw the window
-    redraw_frame(frame, frame->screen, t, b, l, r);
+    redraw_frame(ws, frame, frame->screen, t, b, l, r);
 }
 
-void workspace_add_window(workspace_t *ws, window_t *window, bool map_now){
+// make a window part of a workspace, without putting it anywhere yet
+static ws_win_info_t *new_info(workspace_t *ws, window_t *window){
     window_ref_up(window);
 
     // allocate/init win_info struct
-    ws_win_info_t *info = malloc(sizeof(*info));
+    ws_win_info_t *info = slab_alloc(&ws->info_slab);
     if(!info){
         window_ref_down(window);
-        return;
+        return NULL;
     }
-    *info = (ws_win_info_t){.window = window};
+    *info = (ws_win_info_t){.window = window, .ws = ws};
 
     // pack info into hash table
     khint_t k;
@@ -196,17 +316,24 @@ void workspace_add_window(workspace_t *ws, window_t *window, bool map_now){
     k = kh_put(wswl, ws->windows, window, &ret);
     if(ret < 0){
         window_ref_down(window);
-        free(info);
-        return;
+        slab_free(info);
+        return NULL;
     }
     // write to index
     kh_value(ws->windows, k) = info;
+    window_add_member(window, info);
+    return info;
+}
+
+void workspace_add_window(workspace_t *ws, window_t *window, bool map_now){
+    ws_win_info_t *info = new_info(ws, window);
+    if(!info) return;
 
     if(map_now){
         // hide whatever window is currently in the focused frame
         workspace_remove_window_from_frame(ws, ws->focus, false);
         // draw this window
-        draw_window(info, ws->focus);
+        draw_window(ws, info, ws->focus);
         // give the window focus
         workspace_focus_frame(ws, ws->focus);
     }else{
@@ -231,11 +358,19 @@ void workspace_remove_window(workspace_t *ws, window_t *window){
     workspace_remove_window_from_frame(ws, info->frame, false);
     // remove from hidden list
     hidden_remove(ws, info);
-    // replace with another window
-    workspace_next_hidden_win_at(ws, frame);
+    mru_remove(ws, info);
+    // replace with the window that was used last, without moving the focus
+    ws_win_info_t *next = frame ? recent_hidden(ws) : NULL;
+    if(next){
+        hidden_remove(ws, next);
+        draw_window(ws, next, frame);
+    }
+    // the keyboard can't stay with a window that isn't in the frame anymore
+    if(frame && ws->focus == frame) workspace_focus_frame(ws, frame);
     // no more references from this workspace
+    window_remove_member(info->window, info);
     window_ref_down(info->window);
-    free(info);
+    slab_free(info);
 }
 
 void workspace_remove_window_from_frame(workspace_t *ws, split_t *split,
@@ -247,6 +382,7 @@ void workspace_remove_window_from_frame(workspace_t *ws, split_t *split,
     if(g_workspace == ws){
         be_window_hide(info->window->be_window);
     }
+    split_touch(split);
     split->win_info = NULL;
     info->frame = NULL;
     if(prepend_old_window)
@@ -255,99 +391,281 @@ void workspace_remove_window_from_frame(workspace_t *ws, split_t *split,
         hidden_append(ws, info);
 }
 
-static int hide_cb(split_t *split, void *data,
-                   float t, float b, float l, float r){
+/* Only leaves track their screen (split_new copies it from the leaf being
+   split), so the walks below skip the inner splits entirely. */
+
+static split_walk_t hide_cb(split_t *split, void *data,
+                            float t, float b, float l, float r){
     (void)data; (void)t; (void)b; (void)l; (void)r;
     // split is no longer associated with a screen
     split->screen = NULL;
-    // that's all we do for non-leaves
-    if(!split->isleaf) return 0;
     // do nothing if this leaf has no window
-    if(!split->win_info) return 0;
+    if(!split->win_info) return SPLIT_WALK_CONTINUE;
     // hide window
     be_window_hide(split->win_info->window->be_window);
-    return 0;
+    return SPLIT_WALK_CONTINUE;
 }
 
-// unmap all windows in workspace
+/* Unmap all windows in workspace.  The leaves stay in the index, with the
+   rectangles they had, so that restoring the workspace only has to touch
+   what changed in the meantime.  Those rectangles are stale until then, so
+   anything asking where a leaf is has to check leaf->screen first. */
 void workspace_hide(workspace_t *ws){
-    for(size_t i = 0; i < ws->nroots; i++){
-        split_do_at_each(ws->roots[i], hide_cb, NULL);
+    if(ws->nroots){
+        // every leaf of every root is on one thread
+        split_t *leaf = split_first_leaf(ws->roots[0]);
+        for(; leaf; leaf = leaf->next_leaf){
+            hide_cb(leaf, NULL, 0, 0, 0, 0);
+        }
     }
 }
 
-static int restore_cb(split_t *split, void *data,
-                      float t, float b, float l, float r){
-    // dereference screen
-    screen_t *screen = data;
+typedef struct {
+    workspace_t *ws;
+    screen_t *screen;
+} restore_data_t;
+
+static split_walk_t restore_cb(split_t *split, void *data,
+                               float t, float b, float l, float r){
+    // dereference workspace and screen
+    restore_data_t *rd = data;
     // save screen
-    split->screen = screen;
-    // that's all we do for non-leaves
-    if(!split->isleaf) return 0;
-    // do nothing if this leaf has no window
-    if(!split->win_info) return 0;
-    // draw the window
-    redraw_frame(split, screen, t, b, l, r);
-    return 0;
+    split->screen = rd->screen;
+    // index the leaf and draw any window in it
+    redraw_frame(rd->ws, split, rd->screen, t, b, l, r);
+    return SPLIT_WALK_CONTINUE;
+}
+
+// redraw leaves in place, such as after their parent changed shape
+static split_walk_t relayout_cb(split_t *split, void *data,
+                                float t, float b, float l, float r){
+    // dereference workspace
+    workspace_t *ws = data;
+    if(split->screen){
+        redraw_frame(ws, split, split->screen, t, b, l, r);
+    }
+    return SPLIT_WALK_CONTINUE;
 }
 
-static int pre_rm_root_cb(split_t *split, void *data,
-                          float t, float b, float l, float r){
+static split_walk_t pre_rm_root_cb(split_t *split, void *data,
+                                   float t, float b, float l, float r){
     (void)t; (void)b; (void)l; (void)r;
     // dereference workspace
     workspace_t *ws = data;
+    // the frame is about to be freed
+    leafindex_remove(ws->leafidx, split);
     // remove any window in the frame (and list it as hidden)
     workspace_remove_window_from_frame(ws, split, false);
-    return 0;
+    return SPLIT_WALK_CONTINUE;
 }
 
 
-// restore windows to their frames, and render to the existing screens
+/* the leaf which had focus most recently, or the first leaf if none of them
+   ever had focus.  Focusing a frame only stamps it, since split.c frees and
+   merges leaves on its own, so finding the most recent one is a walk over the
+   leaves.  That only happens when the focused frame goes away. */
+static split_t *recent_frame(workspace_t *ws){
+    if(!ws->nroots) return NULL;
+    split_t *best = split_first_leaf(ws->roots[0]);
+    for(split_t *leaf = best; leaf; leaf = leaf->next_leaf){
+        if(leaf->focused > best->focused) best = leaf;
+    }
+    return best;
+}
+
+static split_t *root_of(split_t *split){
+    while(split->parent) split = split->parent;
+    return split;
+}
+
+// the nth leaf of a root, or NULL if it doesn't have that many
+static split_t *nth_leaf(split_t *root, size_t n){
+    split_t *end = split_last_leaf(root)->next_leaf;
+    split_t *leaf = split_first_leaf(root);
+    for(size_t i = 0; leaf != end; leaf = leaf->next_leaf, i++){
+        if(i == n) return leaf;
+    }
+    return NULL;
+}
+
+/* Put the windows of a parked root back where they were, if they are still
+   hidden in this workspace.  Windows which found another frame meanwhile
+   stay there.  The snapshot names windows by handle, so a window which
+   closed while the screen was gone is skipped, even if a new window took
+   its memory.  Leaves are drawn later, by workspace_restore(). */
+static void unpark_windows(workspace_t *ws, split_t *split, snap_t *snap){
+    if(split->isleaf != snap->isleaf) return;
+    if(!split->isleaf){
+        // this part couldn't be built
+        if(split->nframes != snap->nframes) return;
+        for(size_t i = 0; i < split->nframes; i++){
+            unpark_windows(ws, split->frames[i], snap->frames[i]);
+        }
+        return;
+    }
+    window_t *window = winhandle_get(snap->window);
+    if(!window) return;
+    khiter_t k = kh_get(wswl, ws->windows, window);
+    if(k == kh_end(ws->windows)) return;
+    ws_win_info_t *info = kh_value(ws->windows, k);
+    if(info->frame) return;
+    hidden_remove(ws, info);
+    split_touch(split);
+    split->win_info = info;
+    info->frame = split;
+}
+
+/* Grow a new root into the layout saved or parked for its screen, if there
+   is one.  Returns the frame which had focus, or NULL. */
+static split_t *take_saved_root(workspace_t *ws, split_t *root){
+    saved_root_t **prev = &ws->saved;
+    for(; *prev; prev = &(*prev)->next){
+        if(strcmp((*prev)->screen, root->screen_id) == 0) break;
+    }
+    saved_root_t *saved = *prev;
+    if(!saved) return NULL;
+    *prev = saved->next;
+    saved->next = NULL;
+
+    if(split_build(root, saved->snap)){
+        logmsg("no memory to restore saved layout\n");
+    }
+    unpark_windows(ws, root, saved->snap);
+    split_t *focus = NULL;
+    if(saved->focus != SIZE_MAX) focus = nth_leaf(root, saved->focus);
+    saved_root_free(saved);
+    return focus;
+}
+
+/* Set a root aside until its screen comes back.  Its windows are listed as
+   hidden meanwhile, so they can still be reached. */
+static void park_root(workspace_t *ws, split_t *root){
+    saved_root_t *saved = saved_root_new(ws, root);
+    if(saved){
+        // a screen only gets one parked root
+        saved_root_t **prev = &ws->saved;
+        for(; *prev; prev = &(*prev)->next){
+            if(strcmp((*prev)->screen, saved->screen) != 0) continue;
+            saved_root_t *old = *prev;
+            *prev = old->next;
+            old->next = NULL;
+            saved_root_free(old);
+            break;
+        }
+        saved->next = ws->saved;
+        ws->saved = saved;
+    }else{
+        logmsg("no memory to park layout, it will be lost\n");
+    }
+    // the focus can't stay in a frame that is going away
+    if(ws->focus && root_of(ws->focus) == root) ws->focus = NULL;
+    // remove windows from frame and list them as hidden
+    split_walk(root, pre_rm_root_cb, ws, SPLIT_WALK_LEAVES_ONLY);
+    split_free(root);
+}
+
+/* Restore windows to their frames, and render to the existing screens.
+
+   Each root belongs to the screen named by its screen_id, so roots follow
+   their monitors around no matter what order the screens are listed in.
+   The roots of screens which went away are parked in ws->saved, and come
+   back with their windows when the same monitor is plugged in again.  Roots
+   whose screens are still here keep their frames and windows as they were,
+   so their windows are redrawn at the sizes they already have, which the
+   backend doesn't need to send to the clients again. */
 void workspace_restore(workspace_t *ws){
-    /* TODO: think of a better way to do weakly-persistent root-screen mappings
-             (this strategy is OK only in the trivial case (no changes) and
-             it is at least safe in more complex cases) */
+    // Step 1: line up one root per screen, in screen order
+    size_t n = 0;
+    split_t *saved_focus = NULL;
+    for(size_t i = 0; i < g_nscreens; i++){
+        const char *id = be_screen_get_id(g_screens[i]->be_screen);
+        size_t j = n;
+        for(; j < ws->nroots; j++){
+            if(strcmp(ws->roots[j]->screen_id, id) == 0) break;
+        }
+        if(j == ws->nroots){
+            // a screen we don't have a root for
+            split_t *newroot = split_new(&ws->split_slab, NULL);
+            int err = !newroot;
+            if(!err){
+                newroot->screen_id = strdup(id);
+                err = !newroot->screen_id;
+            }
+            if(!err){
+                APPEND_PTR(ws->roots, ws->roots_size, ws->nroots, newroot,
+                           err);
+            }
+            if(err){
+                split_free(newroot);
+                logmsg("no memory to restore workspace\n");
+                // just don't draw on the rest of the screens I guess
+                break;
+            }
+            // bring back the layout it had before, if there was one
+            split_t *focus = take_saved_root(ws, newroot);
+            if(focus) saved_focus = focus;
+            /* a screen with nothing on it shows the first hidden window,
+               such as one sent here before the workspace was ever shown */
+            if(newroot->isleaf && !newroot->win_info && ws->hidden_first){
+                ws_win_info_t *info = hidden_pop_first(ws);
+                split_touch(newroot);
+                newroot->win_info = info;
+                info->frame = newroot;
+            }
+        }
+        split_t *temp = ws->roots[n];
+        ws->roots[n] = ws->roots[j];
+        ws->roots[j] = temp;
+        n++;
+    }
 
-    // Step 1: too many roots?
-    while(ws->nroots > g_nscreens){
-        // pull out one root
-        split_t *root = ws->roots[ws->nroots - 1];
-        ws->nroots--;
-        // remove windows from frame and list them as hidden
-        split_do_at_each(root, pre_rm_root_cb, ws);
-        split_free(root);
+    // Step 2: park the roots which are left over
+    while(ws->nroots > n){
+        park_root(ws, ws->roots[--ws->nroots]);
     }
 
     /* if this is called during the screen_destroy handler, it's possible that
        we are about to exit and there are no screens left.  Stop here. */
-    if(!g_nscreens) return;
-
-    // Step 2: too few roots?
-    while(ws->nroots < g_nscreens){
-        split_t *newroot = split_new(NULL);
-        int err;
-        APPEND_PTR(ws->roots, ws->roots_size, ws->nroots, newroot, err);
-        if(err){
-            logmsg("no memory to restore workspace\n");
-            // just don't draw on that screen I guess
-            break;
-        }
+    if(!ws->nroots) return;
+
+    // Step 3: thread the leaves of every root together, in screen order
+    for(size_t i = 0; i < ws->nroots; i++){
+        split_first_leaf(ws->roots[i])->prev_leaf = NULL;
+        split_last_leaf(ws->roots[i])->next_leaf = NULL;
+        if(i > 0) split_join_leaves(ws->roots[i - 1], ws->roots[i]);
     }
 
-    // Step 3:  now map everything in place
+    // Step 4:  now map everything in place
     for(size_t i = 0; i < ws->nroots; i++){
-        split_do_at_each(ws->roots[i], restore_cb, g_screens[i]);
+        restore_data_t rd = {.ws = ws, .screen = g_screens[i]};
+        split_walk(ws->roots[i], restore_cb, &rd, SPLIT_WALK_LEAVES_ONLY);
     }
 
-    // TODO: don't reset the focus frame all the time
-    ws->focus = ws->roots[0];
-    while(!ws->focus->isleaf) ws->focus = ws->focus->frames[0];
+    /* keep the old focus if there was one, so a screen coming or going
+       doesn't move the keyboard around.  Otherwise use the focus of a saved
+       layout, or the frame that had focus most recently. */
+    if(!ws->focus) ws->focus = saved_focus;
+    if(!ws->focus) ws->focus = recent_frame(ws);
+}
+
+split_t *workspace_next_frame(workspace_t *ws, split_t *start){
+    if(start->next_leaf) return start->next_leaf;
+    // wrap around to the first screen
+    return split_first_leaf(ws->roots[0]);
+}
+
+split_t *workspace_prev_frame(workspace_t *ws, split_t *start){
+    if(start->prev_leaf) return start->prev_leaf;
+    // wrap around to the last screen
+    return split_last_leaf(ws->roots[ws->nroots - 1]);
 }
 
 // trigger workspace to update window focus
 void workspace_focus_frame(workspace_t *ws, split_t *frame){
     // store this frame as the focus of the workspace
     ws->focus = frame;
+    frame->focused = ++ws->focus_clock;
+    if(frame->win_info) mru_touch(ws, frame->win_info);
     // focus on the window if this workspace is active
     if(g_workspace == ws){
         if(frame->win_info){
@@ -358,15 +676,93 @@ void workspace_focus_frame(workspace_t *ws, split_t *frame){
     }
 }
 
+/* find the nearest screen past an edge of a rect, in the given direction.
+   Returns false if there isn't one. */
+static bool screen_past_edge(rect_t from, bool vertical, bool increasing,
+                             rect_t *out){
+    bool found = false;
+    int32_t best = 0;
+    for(size_t i = 0; i < g_nscreens; i++){
+        int32_t x, y;
+        uint32_t w, h;
+        be_screen_get_geometry(g_screens[i]->be_screen, &x, &y, &w, &h);
+        rect_t s = {.t = y, .b = y + (int32_t)h, .l = x, .r = x + (int32_t)w};
+        // how far past the edge is this screen?
+        int32_t dist;
+        if(vertical){
+            dist = increasing ? s.t - from.b : from.t - s.b;
+        }else{
+            dist = increasing ? s.l - from.r : from.l - s.r;
+        }
+        if(dist < 0) continue;
+        if(!found || dist < best){
+            found = true;
+            best = dist;
+            *out = s;
+        }
+    }
+    return found;
+}
+
+static int32_t clamp(int32_t val, int32_t min, int32_t max){
+    return val < min ? min : (val > max ? max : val);
+}
+
+split_t *workspace_neighbor(workspace_t *ws, split_t *start, bool vertical,
+                            bool increasing){
+    /* a frame that isn't on a screen can only move within its own tree.  The
+       leaves of a hidden workspace stay indexed, but with stale rects, so
+       being in the index doesn't mean being on a screen. */
+    if(!start->screen || !start->leafidx_node){
+        return do_split_move(start, vertical, increasing);
+    }
+    /* probe the point just across the edge we are crossing, at the middle of
+       that edge (like do_split_move does) */
+    rect_t from = start->rect;
+    int32_t x, y;
+    if(vertical){
+        x = from.l + (from.r - from.l) / 2;
+        y = increasing ? from.b : from.t - 1;
+    }else{
+        x = increasing ? from.r : from.l - 1;
+        y = from.t + (from.b - from.t) / 2;
+    }
+    split_t *out = leafindex_at(ws->leafidx, x, y);
+    if(out) return out;
+    /* the probe landed outside of every screen, so jump to the nearest screen
+       in that direction, as close to the probe as that screen allows */
+    rect_t s;
+    if(!screen_past_edge(from, vertical, increasing, &s)) return start;
+    if(vertical){
+        x = clamp(x, s.l, s.r - 1);
+        y = increasing ? s.t : s.b - 1;
+    }else{
+        x = increasing ? s.l : s.r - 1;
+        y = clamp(y, s.t, s.b - 1);
+    }
+    out = leafindex_at(ws->leafidx, x, y);
+    return out ? out : start;
+}
+
+split_t *workspace_frame_at(workspace_t *ws, int32_t x, int32_t y){
+    split_t *frame = leafindex_at(ws->leafidx, x, y);
+    // a hidden workspace's leaves are only where they used to be
+    return frame && frame->screen ? frame : NULL;
+}
+
 static void workspace_do_split(workspace_t *ws, split_t *split, bool vertical,
                                float fraction){
-    // first child inherits whatever was in the old split (window, focus)
-    int ret = split_do_split(split, vertical, fraction);
-    if(ret) return;
+    workspace_checkpoint(ws);
+    // the first frame inherits whatever was in the old split (window, focus)
+    split_t *new = split_do_split(split, vertical, fraction);
+    if(!new) return;
+    split_t *first = new->parent->frames[new->idx - 1];
+    // if the old leaf is not a leaf anymore, only its children are indexed
+    if(!split->isleaf) leafindex_remove(ws->leafidx, split);
     // redraw window if there was one
-    draw_window(split->frames[0]->win_info, split->frames[0]);
-    // second child gets a window if one was hidden
-    draw_window(hidden_pop_first(ws), split->frames[1]);
+    draw_window(ws, first->win_info, first);
+    // new frame gets a window if one was hidden
+    draw_window(ws, hidden_pop_first(ws), new);
 }
 
 void workspace_vsplit(workspace_t *ws, split_t *split, float fraction){
@@ -380,28 +776,189 @@ void workspace_hsplit(workspace_t *ws, split_t *split, float fraction){
 void workspace_remove_frame(workspace_t *ws, split_t *split){
     // don't do this to root frames
     if(!split->parent) return;
+    workspace_checkpoint(ws);
     // remove any window
     workspace_remove_window_from_frame(ws, split, false);
+    // unindex the frames which split_do_remove will free
+    split_t *parent = split->parent;
+    leafindex_remove(ws->leafidx, split);
+    if(parent->nframes == 2){
+        // the other frame will be merged into the parent
+        leafindex_remove(ws->leafidx, parent->frames[1 - split->idx]);
+    }
     // remove the frame
-    split_t *remains = split_do_remove(split);
-    // fix focus if necessary
-    if(ws->focus == split){
-        workspace_focus_frame(ws, remains);
+    bool had_focus = (ws->focus == split);
+    split_t *heir = split_do_remove(split);
+    // the focus goes back to where it was before
+    if(had_focus) workspace_focus_frame(ws, recent_frame(ws));
+    if(g_workspace == ws){
+        // only the frames near the removed frame changed shape
+        split_t *changed = heir->parent ? heir->parent : heir;
+        split_walk(changed, relayout_cb, ws, SPLIT_WALK_LEAVES_ONLY);
+    }
+}
+
+void workspace_resize(workspace_t *ws, split_t *split, bool vertical,
+                      float delta){
+    split_t *changed = split_do_resize(split, vertical, delta);
+    if(!changed) return;
+    layoutfile_changed();
+    if(g_workspace == ws){
+        split_walk(changed, relayout_cb, ws, SPLIT_WALK_LEAVES_ONLY);
+    }
+}
+
+// is *leaf somewhere under *split?
+static bool is_under(split_t *leaf, split_t *split){
+    for(; leaf; leaf = leaf->parent){
+        if(leaf == split) return true;
+    }
+    return false;
+}
+
+/* Find the split which owns a border, and which of its bounds the border is.
+   The frame just past the border is written to *after. */
+static split_t *find_border(workspace_t *ws, border_t *border, size_t *i,
+                            split_t **after){
+    int32_t x = border->vertical ? border->across : border->at;
+    int32_t y = border->vertical ? border->at : border->across;
+    split_t *past = leafindex_at(ws->leafidx, x, y);
+    split_t *before = border->vertical ? leafindex_at(ws->leafidx, x, y - 1)
+                                       : leafindex_at(ws->leafidx, x - 1, y);
+    if(!past || !before || past == before) return NULL;
+    // the border is between two children of the frames' common ancestor
+    for(split_t *s = past; s->parent; s = s->parent){
+        split_t *parent = s->parent;
+        if(parent->isvertical != border->vertical || s->idx == 0) continue;
+        if(is_under(before, parent->frames[s->idx - 1])){
+            *i = s->idx;
+            *after = past;
+            return parent;
+        }
+    }
+    return NULL;
+}
+
+// how close the pointer has to be to grab a border, in pixels
+#define BORDER_GRAB 4
+
+bool workspace_border_at(workspace_t *ws, int32_t x, int32_t y,
+                         border_t *out){
+    split_t *frame = workspace_frame_at(ws, x, y);
+    if(!frame) return false;
+    rect_t r = frame->rect;
+    border_t candidates[] = {
+        {.vertical = true, .at = r.t, .across = x},
+        {.vertical = true, .at = r.b, .across = x},
+        {.vertical = false, .at = r.l, .across = y},
+        {.vertical = false, .at = r.r, .across = y},
+    };
+    int32_t dists[] = {y - r.t, r.b - 1 - y, x - r.l, r.r - 1 - x};
+    for(size_t c = 0; c < sizeof(dists) / sizeof(*dists); c++){
+        if(dists[c] >= BORDER_GRAB) continue;
+        size_t i;
+        split_t *after;
+        if(find_border(ws, &candidates[c], &i, &after)){
+            *out = candidates[c];
+            return true;
+        }
     }
+    return false;
+}
+
+bool workspace_drag_border(workspace_t *ws, border_t *border,
+                           int32_t x, int32_t y){
+    size_t i;
+    split_t *after;
+    split_t *split = find_border(ws, border, &i, &after);
+    if(!split || !after->screen) return false;
+    // where the split is on its screen
+    int32_t sx, sy;
+    uint32_t w, h;
+    be_screen_get_geometry(after->screen->be_screen, &sx, &sy, &w, &h);
+    sides_t sides = get_sides(split);
+    float lo = border->vertical ? sides.t : sides.l;
+    float hi = border->vertical ? sides.b : sides.r;
+    int32_t origin = border->vertical ? sy : sx;
+    int size = border->vertical ? (int)h : (int)w;
+    int32_t p0 = origin + frac_of(lo, size);
+    int32_t p1 = origin + frac_of(hi, size);
+    if(p1 <= p0) return false;
+    // move the bound under the pointer
+    int32_t to = border->vertical ? y : x;
+    float bound = split_set_bound(split, i, (float)(to - p0) / (p1 - p0));
+    layoutfile_changed();
+    // the same math as the relayout, so the border can be found again
+    border->at = origin + frac_of(lo + (hi - lo)*bound, size);
     if(g_workspace == ws){
-        // rerender workspace (recursive redraw necessary in some cases)
-        logmsg("rerender!\n");
-        workspace_rerender(ws);
+        split_walk(split, relayout_cb, ws, SPLIT_WALK_LEAVES_ONLY);
+    }
+    return true;
+}
+
+/* The bulk operations below change the whole tree first and draw afterwards,
+   so each window that moves gets exactly one new geometry. */
+
+void workspace_only(workspace_t *ws, split_t *split){
+    // nothing to do for a root frame
+    if(!split->parent) return;
+    workspace_checkpoint(ws);
+    split_t *root = split;
+    while(root->parent) root = root->parent;
+    // hide every other window in the tree, and unindex every frame
+    split_t *leaf = split_first_leaf(root);
+    split_t *end = split_last_leaf(root)->next_leaf;
+    for(; leaf != end; leaf = leaf->next_leaf){
+        if(leaf != split){
+            workspace_remove_window_from_frame(ws, leaf, false);
+        }
+        leafindex_remove(ws->leafidx, leaf);
     }
+    // collapse the tree
+    bool had_focus = (ws->focus == split);
+    root = split_do_only(split);
+    if(had_focus) ws->focus = root;
+    // one redraw for the one window left
+    draw_window(ws, root->win_info, root);
+    if(had_focus) workspace_focus_frame(ws, root);
+}
+
+void workspace_tile_hidden(workspace_t *ws, split_t *split){
+    // count the windows that need a frame
+    size_t n = split->win_info ? 1 : 0;
+    for(ws_win_info_t *info = ws->hidden_first; info; info = info->next){
+        n++;
+    }
+    if(n < 2){
+        // no need for a grid
+        if(!split->win_info) workspace_next_hidden_win_at(ws, split);
+        return;
+    }
+    workspace_checkpoint(ws);
+    // the old frame won't be a leaf anymore
+    leafindex_remove(ws->leafidx, split);
+    bool had_focus = (ws->focus == split);
+    split_t *last;
+    split_do_grid(split, n, &last);
+    split_t *first = split_first_leaf(split);
+    if(had_focus) ws->focus = first;
+    // fill the empty frames, then draw each frame once
+    split_t *end = last->next_leaf;
+    for(split_t *leaf = first; leaf != end; leaf = leaf->next_leaf){
+        if(!leaf->win_info) leaf->win_info = hidden_pop_first(ws);
+        draw_window(ws, leaf->win_info, leaf);
+    }
+    if(had_focus) workspace_focus_frame(ws, first);
 }
 
 void workspace_swap_windows_from_frames(split_t *src, split_t *dst){
     if(!src || !dst || src == dst) return;
+    workspace_checkpoint(g_workspace);
     ws_win_info_t *src_info = src->win_info;
     ws_win_info_t *dst_info = dst->win_info;
     // place the windows in their new frames
-    draw_window(src_info, dst);
-    draw_window(dst_info, src);
+    draw_window(g_workspace, src_info, dst);
+    draw_window(g_workspace, dst_info, src);
     // dst might inherit focus from src
     if(g_workspace->focus == src) g_workspace->focus = dst;
 }
@@ -413,7 +970,7 @@ void workspace_next_hidden_win_at(workspace_t *ws, split_t *split){
     // remove any window
     workspace_remove_window_from_frame(ws, split, false);
     // place new window
-    draw_window(info, split);
+    draw_window(ws, info, split);
     workspace_focus_frame(ws, split);
 }
 
@@ -424,6 +981,414 @@ void workspace_prev_hidden_win_at(workspace_t *ws, split_t *split){
     // remove any window
     workspace_remove_window_from_frame(ws, split, true);
     // place new window
-    draw_window(info, split);
+    draw_window(ws, info, split);
+    workspace_focus_frame(ws, split);
+}
+
+void workspace_reindex_window(workspace_t *ws, ws_win_info_t *info){
+    // only hidden windows are indexed
+    if(info->frame) return;
+    hidden_unindex(ws, info);
+    hidden_index(ws, info);
+}
+
+// show a hidden window in a frame, and focus it
+static void show_hidden(workspace_t *ws, ws_win_info_t *info, split_t *split){
+    hidden_remove(ws, info);
+    // the old window goes to the back of the queue, like with next_hidden
+    workspace_remove_window_from_frame(ws, split, false);
+    draw_window(ws, info, split);
     workspace_focus_frame(ws, split);
 }
+
+bool workspace_bring_window(workspace_t *ws, split_t *split, int by,
+                            const char *key){
+    if(!split) return false;
+    ws_win_info_t *info = winindex_get(ws->hidden_by[by], key);
+    if(!info) return false;
+    show_hidden(ws, info, split);
+    return true;
+}
+
+void workspace_goto_window(window_t *window){
+    // stay on this workspace if the window is here too
+    ws_win_info_t *info = window_member_of(window, g_workspace);
+    if(!info) info = window_members(window);
+    if(!info) return;
+    workspace_t *ws = info->ws;
+    if(ws != g_workspace) workspace_switch(ws);
+    if(info->frame){
+        workspace_focus_frame(ws, info->frame);
+    }else if(ws->focus){
+        show_hidden(ws, info, ws->focus);
+    }
+}
+
+bool workspace_copy_window(workspace_t *dst, window_t *window){
+    if(window_member_of(window, dst)) return true;
+    ws_win_info_t *info = new_info(dst, window);
+    if(!info) return false;
+    // an empty focused frame takes it, otherwise it waits with the hidden
+    split_t *focus = dst->focus;
+    if(focus && !focus->win_info){
+        draw_window(dst, info, focus);
+        if(dst == g_workspace) workspace_focus_frame(dst, focus);
+    }else{
+        hidden_append(dst, info);
+    }
+    return true;
+}
+
+void workspace_add_window_to(workspace_t *ws, window_t *window,
+                             split_t *frame){
+    ws_win_info_t *info = new_info(ws, window);
+    if(!info) return;
+    if(!frame){
+        hidden_append(ws, info);
+        return;
+    }
+    workspace_remove_window_from_frame(ws, frame, true);
+    draw_window(ws, info, frame);
+    // a workspace in the background keeps its focus where it was
+    if(ws == g_workspace) workspace_focus_frame(ws, frame);
+}
+
+split_t *workspace_frame_by_id(workspace_t *ws, uint64_t id){
+    if(!ws->nroots) return NULL;
+    split_t *leaf = split_first_leaf(ws->roots[0]);
+    for(; leaf; leaf = leaf->next_leaf){
+        if(leaf->id == id) return leaf;
+    }
+    return NULL;
+}
+
+split_t *workspace_nth_frame(workspace_t *ws, size_t n){
+    if(!ws->nroots) return NULL;
+    split_t *leaf = split_first_leaf(ws->roots[0]);
+    for(; leaf && n; leaf = leaf->next_leaf) n--;
+    return leaf;
+}
+
+void workspace_move_window(workspace_t *src, workspace_t *dst,
+                           window_t *window){
+    if(src == dst) return;
+    // the copy holds a reference, so the window outlives its removal here
+    if(!workspace_copy_window(dst, window)) return;
+    workspace_remove_window(src, window);
+    // a background workspace which just lost its last window goes away
+    workspace_reclaim(src);
+}
+
+void workspace_window_to_frame(window_t *window, split_t *frame){
+    workspace_t *ws = g_workspace;
+    ws_win_info_t *info = window_member_of(window, ws);
+    if(!info){
+        workspace_add_window_to(ws, window, frame);
+    }else if(info->frame){
+        // whatever was in the frame takes the window's old place
+        workspace_swap_windows_from_frames(info->frame, frame);
+        workspace_focus_frame(ws, frame);
+    }else{
+        show_hidden(ws, info, frame);
+    }
+}
+
+void workspace_window_to_workspace(window_t *window, workspace_t *dst){
+    // it leaves the workspace it's being looked at from, if it can
+    ws_win_info_t *info = window_member_of(window, g_workspace);
+    if(!info) info = window_members(window);
+    if(!info) return;
+    workspace_move_window(info->ws, dst, window);
+}
+
+void workspace_last_window(workspace_t *ws){
+    split_t *focus = ws->focus;
+    if(!focus) return;
+    ws_win_info_t *info = ws->mru_first;
+    if(info && info == focus->win_info) info = info->mru_next;
+    if(!info) return;
+    if(info->frame){
+        // it's already on screen, just go there
+        workspace_focus_frame(ws, info->frame);
+        return;
+    }
+    // swap it with the window in the focused frame
+    hidden_remove(ws, info);
+    workspace_remove_window_from_frame(ws, focus, true);
+    draw_window(ws, info, focus);
+    workspace_focus_frame(ws, focus);
+}
+
+///// Layout History
+
+void workspace_checkpoint(workspace_t *ws){
+    // whatever comes next should make it into the layout file too
+    layoutfile_changed();
+    layout_t *layout = layout_capture(ws);
+    if(!layout){
+        logmsg("no memory to save layout history\n");
+        return;
+    }
+    history_push(ws->history, layout);
+}
+
+static void relayout(workspace_t *ws, split_t *split){
+    if(g_workspace == ws){
+        split_walk(split, relayout_cb, ws, SPLIT_WALK_LEAVES_ONLY);
+    }
+}
+
+/* put a window into a leaf, taking it from wherever it is now.  The window
+   might not be in the workspace anymore, then the leaf is just emptied. */
+static void place_window(workspace_t *ws, split_t *leaf, window_t *window,
+                         bool draw){
+    ws_win_info_t *info = NULL;
+    if(window){
+        khiter_t k = kh_get(wswl, ws->windows, window);
+        if(k != kh_end(ws->windows)) info = kh_value(ws->windows, k);
+    }
+    if(info && info->frame == leaf) return;
+    if(info){
+        workspace_remove_window_from_frame(ws, info->frame, false);
+        hidden_remove(ws, info);
+    }
+    // hide whatever was in the leaf
+    workspace_remove_window_from_frame(ws, leaf, false);
+    if(draw){
+        draw_window(ws, info, leaf);
+    }else{
+        // somebody else will draw it
+        split_touch(leaf);
+        leaf->win_info = info;
+        if(info) info->frame = leaf;
+    }
+}
+
+// fill the leaves of a freshly-built subtree with the snapshot's windows
+static void place_from_snap(workspace_t *ws, split_t *split, snap_t *snap){
+    if(split->isleaf && snap->isleaf){
+        place_window(ws, split, winhandle_get(snap->window), false);
+        return;
+    }
+    if(split->isleaf || snap->isleaf || split->nframes != snap->nframes){
+        // this part couldn't be built
+        return;
+    }
+    for(size_t i = 0; i < split->nframes; i++){
+        place_from_snap(ws, split->frames[i], snap->frames[i]);
+    }
+}
+
+/* Make a live subtree match a snapshot, skipping any subtree which hasn't
+   changed since the snapshot was taken.  Returns true if every leaf under
+   *split needs to be redrawn, which is left to the caller; otherwise only
+   the changed parts were redrawn (unless draw=false). */
+static bool apply_snap(workspace_t *ws, split_t *split, snap_t *snap,
+                       bool draw){
+    if(split->snap == snap) return false;
+    if(split->isleaf && snap->isleaf){
+        place_window(ws, split, winhandle_get(snap->window), draw);
+        return false;
+    }
+    if(!split->isleaf && !snap->isleaf && split->nframes == snap->nframes
+            && split->isvertical == snap->isvertical){
+        // same shape, but the bounds might have moved
+        size_t n = split->nframes;
+        bool moved = memcmp(split->bounds, snap->bounds,
+                            sizeof(*split->bounds) * (n + 1)) != 0;
+        if(moved){
+            split_touch(split);
+            memcpy(split->bounds, snap->bounds,
+                   sizeof(*split->bounds) * (n + 1));
+        }
+        for(size_t i = 0; i < n; i++){
+            bool redraw = apply_snap(ws, split->frames[i], snap->frames[i],
+                                     draw && !moved);
+            if(redraw && draw && !moved) relayout(ws, split->frames[i]);
+        }
+        return moved;
+    }
+    // different shapes, so rebuild this subtree
+    /* the focused leaf is about to be freed (or turned into an inner split),
+       so apply_layout() has to find a new one */
+    if(ws->focus && is_under(ws->focus, split)) ws->focus = NULL;
+    split_t *leaf = split_first_leaf(split);
+    split_t *end = split_last_leaf(split)->next_leaf;
+    for(; leaf != end; leaf = leaf->next_leaf){
+        workspace_remove_window_from_frame(ws, leaf, false);
+        leafindex_remove(ws->leafidx, leaf);
+    }
+    split_collapse(split);
+    if(split_build(split, snap)){
+        logmsg("no memory to restore layout\n");
+    }
+    place_from_snap(ws, split, snap);
+    return true;
+}
+
+static void apply_layout(workspace_t *ws, layout_t *layout){
+    split_t *focus = NULL;
+    for(size_t i = 0; i < ws->nroots; i++){
+        split_t *root = ws->roots[i];
+        size_t leaf;
+        snap_t *snap = layout_find_root(layout, root->screen_id, &leaf);
+        // roots for screens which came or went since then are left alone
+        if(!snap) continue;
+        if(apply_snap(ws, root, snap, true)){
+            relayout(ws, root);
+        }
+        if(leaf != SIZE_MAX) focus = nth_leaf(root, leaf);
+    }
+    // restore the focus, if its screen is still around
+    if(!focus) focus = ws->focus;
+    // the old focus might have been rebuilt away, like in workspace_restore()
+    if(!focus) focus = recent_frame(ws);
+    if(focus) workspace_focus_frame(ws, focus);
+}
+
+void workspace_undo(workspace_t *ws){
+    layout_t *current = layout_capture(ws);
+    if(!current){
+        logmsg("no memory to save layout history\n");
+        return;
+    }
+    layout_t *layout = history_undo(ws->history, current);
+    if(!layout){
+        layout_free(current);
+        return;
+    }
+    apply_layout(ws, layout);
+    layout_free(layout);
+    layoutfile_changed();
+}
+
+void workspace_redo(workspace_t *ws){
+    layout_t *current = layout_capture(ws);
+    if(!current){
+        logmsg("no memory to save layout history\n");
+        return;
+    }
+    layout_t *layout = history_redo(ws->history, current);
+    if(!layout){
+        layout_free(current);
+        return;
+    }
+    apply_layout(ws, layout);
+    layout_free(layout);
+    layoutfile_changed();
+}
+
+///// Workspace Registry
+
+// workspaces by name
+KHASH_MAP_INIT_STR(wsname, workspace_t*)
+static khash_t(wsname) *ws_names = NULL;
+static backend_t *ws_be = NULL;
+
+#define WS_NAME_MAX 64
+
+int workspaces_init(backend_t *be){
+    int err;
+    INIT_PTR(g_workspaces, g_workspaces_size, g_nworkspaces, 8, err);
+    if(err) return -1;
+    ws_names = kh_init(wsname);
+    if(!ws_names){
+        FREE_PTR(g_workspaces, g_workspaces_size, g_nworkspaces);
+        return -1;
+    }
+    ws_be = be;
+    return 0;
+}
+
+void workspaces_free(void){
+    for(size_t i = 0; i < g_nworkspaces; i++){
+        workspace_free(g_workspaces[i]);
+    }
+    FREE_PTR(g_workspaces, g_workspaces_size, g_nworkspaces);
+    kh_destroy(wsname, ws_names);
+    ws_names = NULL;
+}
+
+workspace_t *workspace_find(const char *name){
+    khiter_t k = kh_get(wsname, ws_names, name);
+    if(k == kh_end(ws_names)) return NULL;
+    return kh_value(ws_names, k);
+}
+
+// names have to be one printable word, so they fit in the layout file
+static bool valid_name(const char *name){
+    size_t len = strlen(name);
+    if(len == 0 || len > WS_NAME_MAX) return false;
+    for(size_t i = 0; i < len; i++){
+        if(!isgraph((unsigned char)name[i])) return false;
+    }
+    return true;
+}
+
+workspace_t *workspace_get(const char *name){
+    workspace_t *ws = workspace_find(name);
+    if(ws) return ws;
+    if(!valid_name(name)){
+        logmsg("bad workspace name\n");
+        return NULL;
+    }
+
+    ws = workspace_new(ws_be);
+    if(!ws) return NULL;
+    ws->name = strdup(name);
+    if(!ws->name) goto cu_ws;
+
+    int err;
+    APPEND_PTR(g_workspaces, g_workspaces_size, g_nworkspaces, ws, err);
+    if(err) goto cu_ws;
+
+    int ret;
+    khiter_t k = kh_put(wsname, ws_names, ws->name, &ret);
+    if(ret < 0) goto cu_list;
+    kh_value(ws_names, k) = ws;
+
+    // pick up any layout saved for this workspace during the last run
+    ws->saved = layoutfile_claim(ws->name);
+    return ws;
+
+cu_list:
+    {
+        bool removed;
+        REMOVE_PTR(g_workspaces, g_workspaces_size, g_nworkspaces, ws,
+                   removed);
+        (void)removed;
+    }
+cu_ws:
+    workspace_free(ws);
+    return NULL;
+}
+
+// no windows and no frames, so nothing would be lost by freeing it
+static bool is_empty(workspace_t *ws){
+    if(kh_size(ws->windows) || ws->saved) return false;
+    for(size_t i = 0; i < ws->nroots; i++){
+        if(!ws->roots[i]->isleaf) return false;
+    }
+    return true;
+}
+
+bool workspace_reclaim(workspace_t *ws){
+    if(ws == g_workspace || !is_empty(ws)) return false;
+    khiter_t k = kh_get(wsname, ws_names, ws->name);
+    if(k != kh_end(ws_names)) kh_del(wsname, ws_names, k);
+    bool removed;
+    REMOVE_PTR(g_workspaces, g_workspaces_size, g_nworkspaces, ws, removed);
+    (void)removed;
+    workspace_free(ws);
+    return true;
+}
+
+void workspace_switch(workspace_t *ws){
+    if(ws == g_workspace) return;
+    workspace_t *old = g_workspace;
+    workspace_hide(old);
+    g_workspace = ws;
+    workspace_restore(ws);
+    workspace_focus_frame(ws, ws->focus);
+    workspace_reclaim(old);
+}
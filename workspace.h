@@ -30,14 +30,139 @@ void workspace_restore(workspace_t *ws);
 // trigger workspace to update window focus
 void workspace_focus_frame(workspace_t *ws, split_t *split);
 
+/* Find the neighboring frame in some direction, which may be on another screen.
+   Never returns NULL; if no move is possible, returns *start. */
+split_t *workspace_neighbor(workspace_t *ws, split_t *start, bool vertical,
+                            bool increasing);
+
+static inline split_t *workspace_neighbor_right(workspace_t *ws,
+                                                split_t *start){
+    return workspace_neighbor(ws, start, false, true);
+}
+static inline split_t *workspace_neighbor_left(workspace_t *ws,
+                                               split_t *start){
+    return workspace_neighbor(ws, start, false, false);
+}
+static inline split_t *workspace_neighbor_up(workspace_t *ws, split_t *start){
+    return workspace_neighbor(ws, start, true, false);
+}
+static inline split_t *workspace_neighbor_down(workspace_t *ws,
+                                               split_t *start){
+    return workspace_neighbor(ws, start, true, true);
+}
+
+/* Cycle through frames in screen order, wrapping around after the last frame
+   of the last screen.  Never returns NULL. */
+split_t *workspace_next_frame(workspace_t *ws, split_t *start);
+split_t *workspace_prev_frame(workspace_t *ws, split_t *start);
+
+// find the frame at a point in global coordinates, or NULL
+split_t *workspace_frame_at(workspace_t *ws, int32_t x, int32_t y);
+
 void workspace_vsplit(workspace_t *ws, split_t *split, float fraction);
 void workspace_hsplit(workspace_t *ws, split_t *split, float fraction);
 
 void workspace_remove_frame(workspace_t *ws, split_t *frame);
 
+/* move a border of a frame along one axis by delta (as a fraction of its
+   parent split), see split_do_resize() */
+void workspace_resize(workspace_t *ws, split_t *split, bool vertical,
+                      float delta);
+
+// a border between frames, in global coordinates
+typedef struct {
+    // true for a horizontal line between frames stacked vertically
+    bool vertical;
+    // the position of the border along the axis
+    int32_t at;
+    // any position along the border itself
+    int32_t across;
+} border_t;
+
+// find a border which could be dragged from (x,y)
+bool workspace_border_at(workspace_t *ws, int32_t x, int32_t y,
+                         border_t *out);
+/* move a border under the pointer, which updates *border.  Returns false if
+   the border is gone, such as after the frames changed. */
+bool workspace_drag_border(workspace_t *ws, border_t *border,
+                           int32_t x, int32_t y);
+
+// remove every frame on the same screen except this one
+void workspace_only(workspace_t *ws, split_t *split);
+// cut a frame into a grid and fill it with every hidden window
+void workspace_tile_hidden(workspace_t *ws, split_t *split);
+
 void workspace_swap_windows_from_frames(split_t *src, split_t *dst);
 
+/* Layout history.  Operations which change the layout call
+   workspace_checkpoint() first, so they can be undone. */
+void workspace_checkpoint(workspace_t *ws);
+void workspace_undo(workspace_t *ws);
+void workspace_redo(workspace_t *ws);
+
+/* Workspaces are made on first use, by name (numbered workspaces are just
+   named "1", "2", and so on), and they go away again once they are empty and
+   out of sight.  g_workspaces lists every workspace that exists right now. */
+
+// returns 0 or -1
+int workspaces_init(backend_t *be);
+// frees every workspace
+void workspaces_free(void);
+// returns NULL if there is no such workspace
+workspace_t *workspace_find(const char *name);
+// find or create a workspace, returns NULL for a bad name or no memory
+workspace_t *workspace_get(const char *name);
+// hide the current workspace and show another one instead
+void workspace_switch(workspace_t *ws);
+/* free a workspace if it has no windows or frames and isn't showing.  Returns
+   true if it was freed. */
+bool workspace_reclaim(workspace_t *ws);
+
 void workspace_next_hidden_win_at(workspace_t *ws, split_t *split);
 void workspace_prev_hidden_win_at(workspace_t *ws, split_t *split);
+/* Go back to the window which had focus before the current one, like
+   alt-tab.  If it's in another frame, that frame gets the focus, otherwise it
+   is brought into the focused frame.  Doing it twice goes back again. */
+void workspace_last_window(workspace_t *ws);
+
+/* Bring the hidden window with a given app_id or title (by=WINDEX_APP_ID or
+   WINDEX_TITLE) into a frame, without cycling through the other hidden
+   windows.  If several match, the one which was hidden first wins.  Returns
+   false if there was no such window. */
+bool workspace_bring_window(workspace_t *ws, split_t *split, int by,
+                            const char *key);
+/* Show a window wherever it is, such as after a search: switch to a
+   workspace it is in (unless the current one has it) and focus its frame, or
+   bring it into the focused frame if it is hidden. */
+void workspace_goto_window(window_t *window);
+/* Give a window to another workspace too.  It goes in the focused frame if
+   that frame is empty, or else to the back of the hidden windows.  Nothing is
+   sent to the client: draw_window() skips frames that aren't on a screen, so
+   the window is only configured once dst is shown, and sorting any number of
+   windows onto workspaces costs nothing until then.  Returns false for no
+   memory.  Already being in dst is fine. */
+bool workspace_copy_window(workspace_t *dst, window_t *window);
+/* Show a window in a frame of the active workspace and focus it.  A window
+   in another frame swaps places with the frame's window, a hidden one is
+   brought in, and a window from another workspace is copied in. */
+void workspace_window_to_frame(window_t *window, split_t *frame);
+/* Move a window to dst, from the active workspace if it's there or else from
+   the first workspace it is in. */
+void workspace_window_to_workspace(window_t *window, workspace_t *dst);
+/* Add a new window to a frame of ws, hiding the frame's old window, or to the
+   hidden windows if frame is NULL.  Only the active workspace moves its
+   focus to the frame. */
+void workspace_add_window_to(workspace_t *ws, window_t *window,
+                             split_t *frame);
+// the frame with this split_t.id, or NULL if it's gone
+split_t *workspace_frame_by_id(workspace_t *ws, uint64_t id);
+// the nth frame in screen order (from 0), or NULL if there aren't that many
+split_t *workspace_nth_frame(workspace_t *ws, size_t n);
+/* copy a window to dst, then take it out of src.  src is freed if that
+   leaves it empty and it isn't showing. */
+void workspace_move_window(workspace_t *src, workspace_t *dst,
+                           window_t *window);
+// a window's title or app_id changed, so it has to be indexed again
+void workspace_reindex_window(workspace_t *ws, ws_win_info_t *info);
 
 #endif // WORKSPACE_H